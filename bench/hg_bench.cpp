@@ -0,0 +1,523 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "hg_graphs_lib.h"
+#include "hg_utils.h"
+#include "hg_math.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+void usage (string exe_name){
+  cout << "NAME: " << endl;
+  cout << "\t" << "hg_bench" << " -- benchmark suite of the Hyperbolic Graph Generator" << endl;
+  cout << endl;
+  cout << "SYNOPSIS: " << endl;
+  cout << "\t" << "hg_bench" << " [parameters] " << endl;
+  cout << endl;
+  cout << "DESCRIPTION:" << endl;
+  cout << "\t" << "The program times the six graph generators at different sizes, the" << endl;
+  cout << "\t" << "numerical solvers (hg_get_R, hg_get_lambda), hg_print_graph and" << endl;
+  cout << "\t" << "hg_read_graph (text, gzip and compressed format), the greedy_routing and" << endl;
+  cout << "\t" << "graph_properties tools (also on the graph relabelled in angular order," << endl;
+  cout << "\t" << "to measure the locality gain). Each case is repeated and its median" << endl;
+  cout << "\t" << "wall time is written in json format." << endl;
+  cout << "\t" << "If a baseline (the json output of a previous run) is provided, the" << endl;
+  cout << "\t" << "program fails (exit code 1) when a case is slower than the baseline." << endl;
+  cout << endl;
+  cout << "PARAMETERS:"<< endl;
+  cout << "\t" << "-n" << "\t" << "comma separated list of graph sizes" << endl;
+  cout << "\t" << "\t" << "default value is 1000,2000" << endl;
+  cout << "\t" << "-r" << "\t" << "repetitions of each case" << endl;
+  cout << "\t" << "\t" << "default value is 5" << endl;
+  cout << "\t" << "-t" << "\t" << "folder containing the tools" << endl;
+  cout << "\t" << "\t" << "default value is ../tools" << endl;
+  cout << "\t" << "-d" << "\t" << "working folder (graphs and properties are written here)" << endl;
+  cout << "\t" << "\t" << "default value is ./bench_data" << endl;
+  cout << "\t" << "-o" << "\t" << "output file (json)" << endl;
+  cout << "\t" << "\t" << "default value is ./bench.json" << endl;
+  cout << "\t" << "-b" << "\t" << "baseline file (json), no comparison if empty" << endl;
+  cout << "\t" << "-e" << "\t" << "tolerance: maximum slowdown w.r.t. the baseline" << endl;
+  cout << "\t" << "\t" << "default value is 0.2 (20%)" << endl;
+  cout << "\t" << "-h" << "\t" << "print help menu" << endl;
+  cout << "\t" << "-q" << "\t" << "quiet (no information print on standard output)" << endl;
+  cout << endl;
+  return;
+}
+
+
+/* ================= benchmark cases  ================= */
+
+
+/* a benchmark case: wall time of each repetition and the
+ * amount of work done in a repetition (e.g. routing attempts),
+ * used to report a throughput */
+typedef struct struct_bench_case {
+  string name;
+  vector<double> times;
+  double work;
+  string unit;
+} bench_case_t;
+
+
+static double wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+static double median(vector<double> v) {
+  if(v.empty()) {
+    return 0;
+  }
+  sort(v.begin(), v.end());
+  size_t h = v.size() / 2;
+  return (v.size() % 2 == 1) ? v[h] : (v[h-1] + v[h]) / 2.0;
+}
+
+
+static bench_case_t new_case(const string name, const double work = 0,
+			     const string unit = "") {
+  bench_case_t bc;
+  bc.name = name;
+  bc.work = work;
+  bc.unit = unit;
+  return bc;
+}
+
+
+static bool run_command(const string command) {
+  hg_debug("running %s", command.c_str());
+  return system(command.c_str()) == 0;
+}
+
+
+/* the pair (gamma, temperature) selects the model */
+typedef struct struct_bench_model {
+  const char * name;
+  double gamma;
+  double temperature;
+} bench_model_t;
+
+static const bench_model_t bench_models[] = {
+  { "hyperbolic_rgg",           2.5,           0 },
+  { "hyperbolic_standard",      2.5,           0.5 },
+  { "soft_configuration_model", 2.5,           HG_INF_TEMPERATURE },
+  { "angular_rgg",              HG_INF_GAMMA,  0 },
+  { "soft_rgg",                 HG_INF_GAMMA,  0.5 },
+  { "erdos_renyi",              HG_INF_GAMMA,  HG_INF_TEMPERATURE }
+};
+
+#define BENCH_NUM_MODELS 6
+#define BENCH_K_BAR 10
+#define BENCH_ROUTING_ATTEMPTS 10000
+
+
+static void bench_generators(const vector<int> & sizes, const int repetitions,
+			     vector<bench_case_t> & cases) {
+  size_t i;
+  int m, r;
+  for(i = 0; i < sizes.size(); i++) {
+    for(m = 0; m < BENCH_NUM_MODELS; m++) {
+      stringstream name;
+      name << "generator_" << bench_models[m].name << "_n" << sizes[i];
+      bench_case_t bc = new_case(name.str(), sizes[i], "nodes/s");
+      for(r = 0; r < repetitions; r++) {
+	double start = wall_time();
+	hg_graph_t * g = hg_graph_generator(sizes[i], BENCH_K_BAR, bench_models[m].gamma,
+					    bench_models[m].temperature, 1, 1);
+	bc.times.push_back(wall_time() - start);
+	delete g;
+      }
+      cases.push_back(bc);
+    }
+  }
+}
+
+
+static void bench_math(const vector<int> & sizes, const int repetitions,
+		       vector<bench_case_t> & cases) {
+  size_t i;
+  int m, r;
+  for(i = 0; i < sizes.size(); i++) {
+    for(m = 0; m < BENCH_NUM_MODELS; m++) {
+      hg_graph_type gt = hg_infer_hg_type(bench_models[m].gamma, bench_models[m].temperature);
+      if(gt == ANGULAR_RGG || gt == ERDOS_RENYI) {
+	continue; // nothing to solve
+      }
+      hg_graph_t g(0);
+      g[boost::graph_bundle].type = gt;
+      g[boost::graph_bundle].expected_n = sizes[i];
+      g[boost::graph_bundle].temperature = bench_models[m].temperature;
+      g[boost::graph_bundle].expected_gamma = bench_models[m].gamma;
+      g[boost::graph_bundle].expected_degree = BENCH_K_BAR;
+      g[boost::graph_bundle].zeta_eta = 1;
+      hg_algorithm_parameters_t p;
+      p.eta = 1;
+      p.c = -1;
+      if(gt == HYPERBOLIC_STANDARD && bench_models[m].temperature > 1) {
+	p.alpha = 0.5 / bench_models[m].temperature * (bench_models[m].gamma - 1.0);
+      }
+      else {
+	p.alpha = 0.5 * (bench_models[m].gamma - 1.0);
+      }
+      stringstream name;
+      name << (gt == SOFT_RGG ? "hg_get_lambda_" : "hg_get_R_") << bench_models[m].name
+	   << "_n" << sizes[i];
+      bench_case_t bc = new_case(name.str());
+      for(r = 0; r < repetitions; r++) {
+	double start = wall_time();
+	if(gt == SOFT_RGG) {
+	  hg_get_lambda(&g, p);
+	}
+	else {
+	  hg_get_R(&g, p);
+	}
+	bc.times.push_back(wall_time() - start);
+      }
+      cases.push_back(bc);
+    }
+  }
+}
+
+
+/* time a tool (each repetition runs command) */
+static bool bench_command(const string name, const string command, const int repetitions,
+			  const double work, const string unit, vector<bench_case_t> & cases) {
+  bench_case_t bc = new_case(name, work, unit);
+  int r;
+  for(r = 0; r < repetitions; r++) {
+    double start = wall_time();
+    if(!run_command(command)) {
+      return false;
+    }
+    bc.times.push_back(wall_time() - start);
+  }
+  cases.push_back(bc);
+  return true;
+}
+
+
+/* greedy_routing and graph_properties on graph_file, the name
+ * of each case is the tool name followed by suffix */
+static bool bench_tools(const string graph_file, const string suffix, const int n,
+			const int repetitions, const string tools_folder, 
+			const string work_folder, vector<bench_case_t> & cases) {
+  stringstream routing;
+  routing << tools_folder << "/greedy_routing -i " << graph_file
+	  << " -a " << BENCH_ROUTING_ATTEMPTS << " > /dev/null";
+  if(!bench_command("greedy_routing" + suffix, routing.str(), repetitions,
+		    BENCH_ROUTING_ATTEMPTS, "attempts/s", cases)) {
+    return false;
+  }
+  string properties = tools_folder + "/graph_properties -q -i " + graph_file +
+    " -o " + work_folder + "/properties" + suffix;
+  return bench_command("graph_properties" + suffix, properties, repetitions,
+		       n, "nodes/s", cases);
+}
+
+
+/* time hg_print_graph and hg_read_graph on graph_file, the
+ * format depends on its extension (.hg or compressed .hgc) */
+static bool bench_io(const hg_graph_t * g, const string graph_file, const string name,
+		     const int repetitions, vector<bench_case_t> & cases) {
+  int r;
+  double links = num_edges(*g);
+  // writer
+  bench_case_t print_case = new_case("hg_print_graph" + name, links, "links/s");
+  for(r = 0; r < repetitions; r++) {
+    double start = wall_time();
+    hg_print_graph(g, graph_file);
+    print_case.times.push_back(wall_time() - start);
+  }
+  cases.push_back(print_case);
+  // reader
+  bench_case_t read_case = new_case("hg_read_graph" + name, links, "links/s");
+  for(r = 0; r < repetitions; r++) {
+    double start = wall_time();
+    hg_graph_t * read = hg_read_graph(graph_file);
+    read_case.times.push_back(wall_time() - start);
+    if(read == NULL) {
+      return false;
+    }
+    delete read;
+  }
+  cases.push_back(read_case);
+  return true;
+}
+
+
+/* I/O (text and gzip) and tools are timed on a hyperbolic standard
+ * graph having the largest size, the tools are also timed on the
+ * same graph relabelled in angular order (hg_relabel_graph),
+ * that is also written and read in the compressed format */
+static bool bench_io_and_tools(const int n, const int repetitions,
+			       const string tools_folder, const string work_folder,
+			       vector<bench_case_t> & cases) {
+  stringstream suffix;
+  suffix << "_n" << n;
+  string graph_file = work_folder + "/graph" + suffix.str() + ".hg";
+  hg_graph_t * g = hg_graph_generator(n, BENCH_K_BAR, bench_models[1].gamma,
+				      bench_models[1].temperature, 1, 1);
+  if(g == NULL) {
+    return false;
+  }
+  bool ok = bench_io(g, graph_file, suffix.str(), repetitions, cases) &&
+    bench_io(g, graph_file + ".gz", "_gzip" + suffix.str(), repetitions, cases);
+  delete g;
+  if(!ok) {
+    return false;
+  }
+  // greedy routing and graph properties
+  if(!bench_tools(graph_file, suffix.str(), n, repetitions, tools_folder, work_folder, cases)) {
+    return false;
+  }
+  // the same on the relabelled graph
+  string relabelled_file = work_folder + "/graph_relabelled" + suffix.str() + ".hg";
+  g = hg_read_graph(graph_file);
+  if(g == NULL) {
+    return false;
+  }
+  vector<unsigned int> permutation;
+  hg_graph_t * relabelled = hg_relabel_graph(g, HG_ORDER_ANGLE, permutation);
+  hg_print_graph(relabelled, relabelled_file);
+  delete g;
+  ok = bench_io(relabelled, work_folder + "/graph_relabelled" + suffix.str() + ".hgc",
+		"_compressed" + suffix.str(), repetitions, cases);
+  delete relabelled;
+  if(!ok) {
+    return false;
+  }
+  return bench_tools(relabelled_file, "_relabelled" + suffix.str(), n, repetitions,
+		     tools_folder, work_folder, cases);
+}
+
+
+/* ================= output and baseline comparison  ================= */
+
+
+static bool write_json(const string filename, const int repetitions,
+		       const vector<bench_case_t> & cases) {
+  ofstream file;
+  file.open(filename.c_str(), ios::out);
+  if(file.fail() || !file.is_open()) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return false;
+  }
+  file << std::setprecision(6) << std::fixed;
+  file << "{" << endl;
+  file << "  \"repetitions\": " << repetitions << "," << endl;
+  file << "  \"cases\": [" << endl;
+  size_t i;
+  for(i = 0; i < cases.size(); i++) {
+    double m = median(cases[i].times);
+    file << "    { \"name\": \"" << cases[i].name << "\", ";
+    file << "\"median\": " << m << ", ";
+    file << "\"min\": " << *min_element(cases[i].times.begin(), cases[i].times.end()) << ", ";
+    file << "\"max\": " << *max_element(cases[i].times.begin(), cases[i].times.end());
+    if(cases[i].work > 0 && m > 0) {
+      file << ", \"throughput\": " << cases[i].work / m;
+      file << ", \"unit\": \"" << cases[i].unit << "\"";
+    }
+    file << " }" << (i + 1 < cases.size() ? "," : "") << endl;
+  }
+  file << "  ]" << endl;
+  file << "}" << endl;
+  file.close();
+  return true;
+}
+
+
+/* median of case name in a json file written by write_json,
+ * returns a negative value if the case is not there */
+static double baseline_median(const string & json, const string name) {
+  string key = "\"name\": \"" + name + "\"";
+  size_t pos = json.find(key);
+  if(pos == string::npos) {
+    return -1;
+  }
+  pos = json.find("\"median\":", pos);
+  if(pos == string::npos) {
+    return -1;
+  }
+  return strtod(json.c_str() + pos + 9, NULL);
+}
+
+
+/* differences below this threshold (seconds) are
+ * considered noise and never reported */
+#define BENCH_NOISE 0.005
+
+static int compare_baseline(const string filename, const double tolerance,
+			    const vector<bench_case_t> & cases, const bool verbose) {
+  ifstream file(filename.c_str());
+  if(file.fail() || !file.is_open()) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return 1;
+  }
+  stringstream content;
+  content << file.rdbuf();
+  string json = content.str();
+  int regressions = 0;
+  size_t i;
+  for(i = 0; i < cases.size(); i++) {
+    double base = baseline_median(json, cases[i].name);
+    if(base < 0) {
+      continue; // new case
+    }
+    double cur = median(cases[i].times);
+    bool slower = cur > base * (1 + tolerance) && cur - base > BENCH_NOISE;
+    if(slower) {
+      regressions++;
+    }
+    if(slower || verbose) {
+      cout << (slower ? "REGRESSION" : "ok") << "\t" << cases[i].name << "\t";
+      cout << base << " -> " << cur << " s";
+      if(base > 0) {
+	cout << " (" << (cur / base - 1) * 100 << "%)";
+      }
+      cout << endl;
+    }
+  }
+  if(verbose || regressions > 0) {
+    cout << regressions << " regression(s) w.r.t. " << filename << endl;
+  }
+  return regressions > 0 ? 1 : 0;
+}
+
+
+
+int main (int argc, char **argv) {
+  // default values
+  vector<int> sizes;
+  int repetitions = 5;
+  string tools_folder = "../tools";
+  string work_folder = "./bench_data";
+  string output_file = "./bench.json";
+  string baseline_file = "";
+  double tolerance = 0.2;
+  bool verbose = true;
+  string sizes_list = "1000,2000";
+
+  int c;
+  opterr = 0;
+  while ((c = getopt (argc, argv, "n:r:t:d:o:b:e:qh")) != -1) {
+    switch (c) {
+    case 'n':
+      sizes_list = optarg;
+      break;
+    case 'r':
+      repetitions = atoi(optarg);
+      break;
+    case 't':
+      tools_folder = optarg;
+      break;
+    case 'd':
+      work_folder = optarg;
+      break;
+    case 'o':
+      output_file = optarg;
+      break;
+    case 'b':
+      baseline_file = optarg;
+      break;
+    case 'e':
+      tolerance = atof(optarg);
+      break;
+    case 'q':
+      verbose = false;
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    default:
+      cout << "Unknown option provided" << endl << endl;
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  stringstream sl(sizes_list);
+  string size;
+  while(getline(sl, size, ',')) {
+    if(atoi(size.c_str()) >= 3) {
+      sizes.push_back(atoi(size.c_str()));
+    }
+  }
+  if(sizes.empty() || repetitions < 1) {
+    hg_enduser_warning("At least one size (n >= 3) and one repetition are required. \n\t  Quitting.");
+    return 1;
+  }
+
+  stringstream s;
+  s << "mkdir -p " << work_folder;
+  system(s.str().c_str());
+
+  vector<bench_case_t> cases;
+  if(verbose) {
+    cout << "Generators" << endl;
+  }
+  bench_generators(sizes, repetitions, cases);
+  if(verbose) {
+    cout << "Numerical solvers" << endl;
+  }
+  bench_math(sizes, repetitions, cases);
+  if(verbose) {
+    cout << "I/O and tools" << endl;
+  }
+  if(!bench_io_and_tools(*max_element(sizes.begin(), sizes.end()), repetitions,
+			 tools_folder, work_folder, cases)) {
+    hg_enduser_warning("I/O and tools benchmark failed. \n\t  Quitting.");
+    return 1;
+  }
+
+  if(!write_json(output_file, repetitions, cases)) {
+    return 1;
+  }
+  if(verbose) {
+    cout << "Written: " << "\t" << output_file << endl;
+  }
+
+  if(!baseline_file.empty()) {
+    return compare_baseline(baseline_file, tolerance, cases, verbose);
+  }
+  return 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "hg_alloc.h"
+#include "hg_profile.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+#define HG_HUGE_PAGE (1 << 21)
+
+// mbind(2) mode, numaif.h (libnuma) is not required
+#define HG_MPOL_INTERLEAVE 3
+#define HG_MAX_NUMA_NODES 1024
+
+
+static hg_placement hg_alloc_placement = HG_PLACEMENT_DEFAULT;
+static hg_page_size hg_alloc_pages = HG_PAGES_DEFAULT;
+
+/* blocks mapped by hg_alloc and their length, the large blocks
+ * allocated with operator new are not in the map */
+static pthread_mutex_t hg_alloc_lock = PTHREAD_MUTEX_INITIALIZER;
+static map<void *, size_t> hg_alloc_blocks;
+
+// statistics (protected by hg_alloc_lock)
+static long hg_alloc_num_blocks = 0;
+static size_t hg_alloc_bytes = 0;
+static size_t hg_alloc_peak_bytes = 0;
+static size_t hg_alloc_huge_bytes = 0;
+static long hg_alloc_fallbacks = 0;
+
+
+void hg_set_allocation(const hg_placement placement, const hg_page_size pages) {
+  hg_alloc_placement = placement;
+  hg_alloc_pages = pages;
+}
+
+
+bool hg_parse_allocation(const string spec, hg_placement & placement,
+			 hg_page_size & pages) {
+  placement = HG_PLACEMENT_DEFAULT;
+  pages = HG_PAGES_DEFAULT;
+  stringstream s(spec);
+  string word;
+  while(getline(s, word, ',')) {
+    if(word == "first-touch") {
+      placement = HG_PLACEMENT_FIRST_TOUCH;
+    }
+    else if(word == "interleave") {
+      placement = HG_PLACEMENT_INTERLEAVE;
+    }
+    else if(word == "thp") {
+      pages = HG_PAGES_TRANSPARENT;
+    }
+    else if(word == "hugetlb") {
+      pages = HG_PAGES_EXPLICIT;
+    }
+    else if(word != "default") {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* online NUMA nodes (e.g. "0-1,3"), a single node when
+ * the information is not available */
+static int hg_numa_nodes(unsigned long * mask) {
+  ifstream file("/sys/devices/system/node/online");
+  string range;
+  int nodes = 0;
+  while(file.good() && getline(file, range, ',')) {
+    int first = 0, last = 0;
+    char dash;
+    stringstream s(range);
+    if(!(s >> first)) continue;
+    last = (s >> dash >> last) ? last : first;
+    for(; first <= last && first < HG_MAX_NUMA_NODES; first++) {
+      if(mask != NULL) {
+	mask[first / (8 * sizeof(unsigned long))] |= 1UL << (first % (8 * sizeof(unsigned long)));
+      }
+      nodes++;
+    }
+  }
+  if(nodes == 0) {
+    if(mask != NULL) {
+      mask[0] = 1;
+    }
+    nodes = 1;
+  }
+  return nodes;
+}
+
+
+static bool hg_interleave(void * p, const size_t len) {
+#ifdef SYS_mbind
+  unsigned long mask[HG_MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = { 0 };
+  hg_numa_nodes(mask);
+  return syscall(SYS_mbind, p, len, HG_MPOL_INTERLEAVE, mask, 
+		 (unsigned long) HG_MAX_NUMA_NODES, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+
+/* each page is written first by the thread that visits that
+ * part of the block in a static loop: the consumers of the
+ * arrays (e.g. the link loops, dynamic or work stealing) do not
+ * follow this split, the placement is approximate */
+static void hg_first_touch(char * p, const size_t len) {
+  long page = sysconf(_SC_PAGESIZE);
+  long pages = len / page;
+  long i;
+#pragma omp parallel for schedule(static)
+  for(i = 0; i < pages; i++) {
+    p[i * page] = 0;
+  }
+}
+
+
+static void * hg_map(const size_t bytes) {
+  size_t page = (hg_alloc_pages == HG_PAGES_DEFAULT) ? sysconf(_SC_PAGESIZE) : HG_HUGE_PAGE;
+  size_t len = (bytes + page - 1) / page * page;
+  char * p = (char *) MAP_FAILED;
+  bool huge = false;
+  bool fallback = false;
+#ifdef MAP_HUGETLB
+  if(hg_alloc_pages == HG_PAGES_EXPLICIT) {
+    p = (char *) mmap(NULL, len, PROT_READ | PROT_WRITE, 
+		      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge = (p != MAP_FAILED);
+    fallback = !huge;
+  }
+#endif
+  if(p == MAP_FAILED) {
+    // a mapping a huge page longer is trimmed to a 2 MB aligned block
+    size_t extra = (page == HG_HUGE_PAGE) ? HG_HUGE_PAGE : 0;
+    char * q = (char *) mmap(NULL, len + extra, PROT_READ | PROT_WRITE, 
+			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(q == MAP_FAILED) {
+      return NULL;
+    }
+    p = q;
+    if(extra > 0) {
+      p = (char *) (((uintptr_t) q + HG_HUGE_PAGE - 1) & ~((uintptr_t) HG_HUGE_PAGE - 1));
+      if(p > q) {
+	munmap(q, p - q);
+      }
+      if(q + len + extra > p + len) {
+	munmap(p + len, (q + len + extra) - (p + len));
+      }
+#ifdef MADV_HUGEPAGE
+      huge = (madvise(p, len, MADV_HUGEPAGE) == 0);
+#endif
+      fallback = fallback || !huge;
+    }
+  }
+  if(hg_alloc_placement == HG_PLACEMENT_INTERLEAVE && !hg_interleave(p, len)) {
+    fallback = true;
+  }
+  if(hg_alloc_placement == HG_PLACEMENT_FIRST_TOUCH) {
+    hg_first_touch(p, len);
+  }
+  pthread_mutex_lock(&hg_alloc_lock);
+  hg_alloc_blocks[p] = len;
+  hg_alloc_num_blocks++;
+  hg_alloc_bytes += len;
+  hg_alloc_peak_bytes = max(hg_alloc_peak_bytes, hg_alloc_bytes);
+  hg_alloc_huge_bytes += huge ? len : 0;
+  if(fallback && hg_alloc_fallbacks++ == 0) {
+    hg_log_warn("The allocation policy is not fully available on this system (see allocation_fallbacks in the profile)");
+  }
+  pthread_mutex_unlock(&hg_alloc_lock);
+  return p;
+}
+
+
+void * hg_alloc(const size_t bytes) {
+  if(bytes < HG_ALLOC_LARGE || 
+     (hg_alloc_placement == HG_PLACEMENT_DEFAULT && hg_alloc_pages == HG_PAGES_DEFAULT)) {
+    return ::operator new(bytes, nothrow);
+  }
+  return hg_map(bytes);
+}
+
+
+void hg_free(void * p, const size_t bytes) {
+  if(p == NULL) {
+    return;
+  }
+  if(bytes >= HG_ALLOC_LARGE) {
+    pthread_mutex_lock(&hg_alloc_lock);
+    map<void *, size_t>::iterator it = hg_alloc_blocks.find(p);
+    if(it != hg_alloc_blocks.end()) {
+      munmap(p, it->second);
+      hg_alloc_bytes -= it->second;
+      hg_alloc_blocks.erase(it);
+      pthread_mutex_unlock(&hg_alloc_lock);
+      return;
+    }
+    pthread_mutex_unlock(&hg_alloc_lock);
+  }
+  ::operator delete(p);
+}
+
+
+void hg_allocation_profile() {
+  const char * placement[] = { "default", "first_touch", "interleave" };
+  const char * pages[] = { "default", "thp", "hugetlb" };
+  HG_Profile::set("allocation_placement", placement[hg_alloc_placement]);
+  HG_Profile::set("allocation_pages", pages[hg_alloc_pages]);
+  HG_Profile::set("allocation_numa_nodes", hg_numa_nodes(NULL));
+  pthread_mutex_lock(&hg_alloc_lock);
+  HG_Profile::set("allocation_large_blocks", hg_alloc_num_blocks);
+  HG_Profile::set("allocation_peak_bytes", hg_alloc_peak_bytes);
+  HG_Profile::set("allocation_huge_page_bytes", hg_alloc_huge_bytes);
+  HG_Profile::set("allocation_fallbacks", hg_alloc_fallbacks);
+  pthread_mutex_unlock(&hg_alloc_lock);
+}
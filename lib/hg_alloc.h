@@ -0,0 +1,150 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _HG_ALLOC_H
+#define _HG_ALLOC_H
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+#include <utility>
+
+
+/* Allocation of the large arrays of the library (coordinates,
+ * CSR offsets and neighbours, link buffers). Blocks smaller than
+ * HG_ALLOC_LARGE always come from operator new; the large ones
+ * follow the policy set by hg_set_allocation:
+ *
+ *   placement  HG_PLACEMENT_DEFAULT      operator new (pages are placed
+ *                                        where the process first writes)
+ *              HG_PLACEMENT_FIRST_TOUCH  the pages are touched by the
+ *                                        threads of a static OpenMP loop
+ *                                        over the block, so that each one
+ *                                        lands on the NUMA node of the
+ *                                        thread that owns that part
+ *              HG_PLACEMENT_INTERLEAVE   the pages are interleaved on all
+ *                                        the NUMA nodes (mbind)
+ *   pages      HG_PAGES_DEFAULT          system default
+ *              HG_PAGES_TRANSPARENT      2 MB aligned blocks advised for
+ *                                        transparent huge pages (madvise)
+ *              HG_PAGES_EXPLICIT         huge pages reserved by the system
+ *                                        (MAP_HUGETLB), transparent ones
+ *                                        when none is available
+ *
+ * Every policy other than the default maps the large blocks with
+ * mmap. The content of the arrays does not depend on the policy.
+ */
+
+#define HG_ALLOC_LARGE (1 << 21)
+
+typedef enum {
+  HG_PLACEMENT_DEFAULT,
+  HG_PLACEMENT_FIRST_TOUCH,
+  HG_PLACEMENT_INTERLEAVE
+} hg_placement;
+
+typedef enum {
+  HG_PAGES_DEFAULT,
+  HG_PAGES_TRANSPARENT,
+  HG_PAGES_EXPLICIT
+} hg_page_size;
+
+/* policy of the next large allocations */
+void hg_set_allocation(const hg_placement placement, const hg_page_size pages);
+
+/* parse a comma separated list of first-touch, interleave, thp 
+ * and hugetlb (e.g. "interleave,thp"), false if a word is unknown */
+bool hg_parse_allocation(const std::string spec, hg_placement & placement,
+			 hg_page_size & pages);
+
+/* add the policy and the statistics of the large allocations
+ * (blocks, bytes, huge pages obtained, NUMA nodes) to the profile */
+void hg_allocation_profile();
+
+/* raw allocation of the arrays, hg_alloc returns NULL on failure,
+ * hg_free takes the size provided to hg_alloc */
+void * hg_alloc(const size_t bytes);
+void hg_free(void * p, const size_t bytes);
+
+
+/* standard allocator for the containers of the large arrays */
+template <class T>
+class hg_allocator {
+public:
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T & reference;
+  typedef const T & const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  template <class U> struct rebind {
+    typedef hg_allocator<U> other;
+  };
+  hg_allocator() throw() {}
+  hg_allocator(const hg_allocator &) throw() {}
+  template <class U> hg_allocator(const hg_allocator<U> &) throw() {}
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  pointer allocate(size_type n, const void * = 0) {
+    void * p = hg_alloc(n * sizeof(T));
+    if(p == NULL) {
+      throw std::bad_alloc();
+    }
+    return static_cast<pointer>(p);
+  }
+  void deallocate(pointer p, size_type n) {
+    hg_free(p, n * sizeof(T));
+  }
+  size_type max_size() const throw() {
+    return size_type(-1) / sizeof(T);
+  }
+  void construct(pointer p, const T & value) {
+    new((void *) p) T(value);
+  }
+  void destroy(pointer p) {
+    p->~T();
+  }
+};
+
+template <class T, class U>
+inline bool operator==(const hg_allocator<T> &, const hg_allocator<U> &) {
+  return true;
+}
+
+template <class T, class U>
+inline bool operator!=(const hg_allocator<T> &, const hg_allocator<U> &) {
+  return false;
+}
+
+
+/* buffer of links (pairs of node ids) filled by the generators */
+typedef std::vector<std::pair<int, int>, hg_allocator<std::pair<int, int> > > hg_link_buffer_t;
+
+
+#endif /* _HG_ALLOC_H */
@@ -0,0 +1,180 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <algorithm>
+#ifdef DEBUG_ON
+#include <assert.h>
+#include <pthread.h>
+#endif
+
+#include "hg_arena.h"
+#include "hg_alloc.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+// blocks are aligned as malloc does
+#define HG_ARENA_ALIGN 16
+
+// free lists, one per block size
+#define HG_ARENA_SIZES (HG_ARENA_MAX_BLOCK / HG_ARENA_ALIGN + 1)
+
+struct struct_hg_arena {
+  vector<char *> chunks;
+  size_t used;  // bytes carved from the last chunk
+  long live;    // blocks not released yet
+  long refs;    // allocators bound to the arena and its creator
+  void * free_blocks[HG_ARENA_SIZES];
+#ifdef DEBUG_ON
+  pthread_t owner; // the only thread allocating and releasing blocks
+#endif
+};
+
+
+static inline size_t hg_arena_size(const size_t bytes) {
+  return (bytes + HG_ARENA_ALIGN - 1) & ~((size_t) HG_ARENA_ALIGN - 1);
+}
+
+
+hg_arena_t * hg_arena_new() {
+  hg_arena_t * a = new hg_arena_t;
+  a->used = 0;
+  a->live = 0;
+  a->refs = 1;
+  fill(a->free_blocks, a->free_blocks + HG_ARENA_SIZES, (void *) NULL);
+#ifdef DEBUG_ON
+  a->owner = pthread_self();
+#endif
+  return a;
+}
+
+
+void hg_arena_free(hg_arena_t * a) {
+  hg_arena_unref(a);
+}
+
+
+void hg_arena_ref(hg_arena_t * a) {
+  if(a != NULL) {
+    __sync_fetch_and_add(&a->refs, 1);
+  }
+}
+
+
+void hg_arena_unref(hg_arena_t * a) {
+  if(a == NULL || __sync_sub_and_fetch(&a->refs, 1) > 0) {
+    return;
+  }
+  unsigned int i;
+  for(i = 0; i < a->chunks.size(); i++) {
+    hg_free(a->chunks[i], HG_ARENA_CHUNK);
+  }
+  delete a;
+}
+
+
+/* the default arena of a thread is referenced by the thread, threads
+ * other than the main one leave it behind when they terminate */
+static __thread hg_arena_t * hg_thread_arena = NULL;
+
+hg_arena_t * hg_arena_default() {
+  if(hg_thread_arena == NULL) {
+    hg_thread_arena = hg_arena_new();
+  }
+  return hg_thread_arena;
+}
+
+
+hg_arena_scope::hg_arena_scope(hg_arena_t * a) : previous(hg_thread_arena) {
+  hg_arena_ref(a);
+  hg_thread_arena = a;
+}
+
+
+hg_arena_scope::~hg_arena_scope() {
+  hg_arena_unref(hg_thread_arena);
+  hg_thread_arena = previous;
+}
+
+
+void * hg_arena_alloc(hg_arena_t * a, const size_t bytes) {
+#ifdef DEBUG_ON
+  assert(pthread_equal(a->owner, pthread_self()));
+#endif
+  size_t size = hg_arena_size(bytes);
+  if(size > HG_ARENA_CHUNK) {
+    hg_log_err("Block of %lu bytes larger than the arena chunks", (unsigned long) bytes);
+    return NULL;
+  }
+  void * p;
+  if(size < HG_ARENA_SIZES * HG_ARENA_ALIGN && a->free_blocks[size / HG_ARENA_ALIGN] != NULL) {
+    // a released block of the same size
+    p = a->free_blocks[size / HG_ARENA_ALIGN];
+    a->free_blocks[size / HG_ARENA_ALIGN] = *(void **) p;
+    a->live++;
+    return p;
+  }
+  if(a->chunks.empty() || a->used + size > HG_ARENA_CHUNK) {
+    char * chunk = (char *) hg_alloc(HG_ARENA_CHUNK);
+    if(chunk == NULL) {
+      return NULL;
+    }
+    a->chunks.push_back(chunk);
+    a->used = 0;
+  }
+  p = a->chunks.back() + a->used;
+  a->used += size;
+  a->live++;
+  return p;
+}
+
+
+void hg_arena_release(hg_arena_t * a, void * p, const size_t bytes) {
+  if(p == NULL) {
+    return;
+  }
+#ifdef DEBUG_ON
+  assert(pthread_equal(a->owner, pthread_self()));
+#endif
+  if(--a->live > 0) {
+    size_t size = hg_arena_size(bytes);
+    if(size < HG_ARENA_SIZES * HG_ARENA_ALIGN) {
+      *(void **) p = a->free_blocks[size / HG_ARENA_ALIGN];
+      a->free_blocks[size / HG_ARENA_ALIGN] = p;
+    }
+    return;
+  }
+  // every block has been released: the first chunk is kept
+  unsigned int i;
+  for(i = 1; i < a->chunks.size(); i++) {
+    hg_free(a->chunks[i], HG_ARENA_CHUNK);
+  }
+  a->chunks.resize(min((size_t) 1, a->chunks.size()));
+  a->used = 0;
+  fill(a->free_blocks, a->free_blocks + HG_ARENA_SIZES, (void *) NULL);
+}
@@ -0,0 +1,163 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _HG_ARENA_H
+#define _HG_ARENA_H
+
+#include <cstddef>
+#include <new>
+
+
+/* Arena for the small blocks of node based containers (the out-edge
+ * sets and the edge list of a graph, the state of a routing attempt):
+ * blocks are carved in order from chunks of HG_ARENA_CHUNK bytes
+ * (allocated with hg_alloc, see hg_alloc.h), a released block is kept
+ * in a free list of its size and reused. When all the blocks of an
+ * arena have been released the arena is rewound and its chunks but
+ * the first are freed. An arena is reference counted (the allocators
+ * bound to it and its creator), it is freed with all its chunks when
+ * the last reference goes, e.g. when the graph using it is destroyed.
+ * An arena is used by the thread that creates it only (checked when
+ * DEBUG_ON is defined).
+ */
+typedef struct struct_hg_arena hg_arena_t;
+
+#define HG_ARENA_CHUNK (1 << 21)
+
+// larger blocks (e.g. vectors) are not allocated in the arena
+#define HG_ARENA_MAX_BLOCK 4096
+
+hg_arena_t * hg_arena_new();
+
+/* release the reference taken by hg_arena_new: the arena and all its
+ * chunks are freed once no allocator is bound to it */
+void hg_arena_free(hg_arena_t * a);
+
+void hg_arena_ref(hg_arena_t * a);
+void hg_arena_unref(hg_arena_t * a);
+
+/* default arena of the calling thread, used by the containers whose
+ * allocator is default constructed (e.g. the out-edge sets of a graph) */
+hg_arena_t * hg_arena_default();
+
+void * hg_arena_alloc(hg_arena_t * a, const size_t bytes);
+void hg_arena_release(hg_arena_t * a, void * p, const size_t bytes);
+
+
+/* standard allocator over an arena, the default one is the arena
+ * of the thread that creates the container */
+template <class T>
+class hg_arena_allocator {
+public:
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T & reference;
+  typedef const T & const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  template <class U> struct rebind {
+    typedef hg_arena_allocator<U> other;
+  };
+  hg_arena_t * arena;
+  hg_arena_allocator() throw() : arena(hg_arena_default()) {
+    hg_arena_ref(arena);
+  }
+  hg_arena_allocator(hg_arena_t * a) throw() : arena(a) {
+    hg_arena_ref(arena);
+  }
+  hg_arena_allocator(const hg_arena_allocator & other) throw() : arena(other.arena) {
+    hg_arena_ref(arena);
+  }
+  template <class U> hg_arena_allocator(const hg_arena_allocator<U> & other) throw() : arena(other.arena) {
+    hg_arena_ref(arena);
+  }
+  hg_arena_allocator & operator=(const hg_arena_allocator & other) throw() {
+    hg_arena_ref(other.arena);
+    hg_arena_unref(arena);
+    arena = other.arena;
+    return *this;
+  }
+  ~hg_arena_allocator() throw() {
+    hg_arena_unref(arena);
+  }
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  pointer allocate(size_type n, const void * = 0) {
+    if(n * sizeof(T) > HG_ARENA_MAX_BLOCK) {
+      return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+    void * p = hg_arena_alloc(arena, n * sizeof(T));
+    if(p == NULL) {
+      throw std::bad_alloc();
+    }
+    return static_cast<pointer>(p);
+  }
+  void deallocate(pointer p, size_type n) {
+    if(n * sizeof(T) > HG_ARENA_MAX_BLOCK) {
+      ::operator delete(p);
+      return;
+    }
+    hg_arena_release(arena, p, n * sizeof(T));
+  }
+  size_type max_size() const throw() {
+    return size_type(-1) / sizeof(T);
+  }
+  void construct(pointer p, const T & value) {
+    new((void *) p) T(value);
+  }
+  void destroy(pointer p) {
+    p->~T();
+  }
+};
+
+/* the default arena of the calling thread is a while the scope
+ * lives (e.g. while a graph and its out-edge sets are built, see
+ * hg_create_graph), the previous one is restored when it ends */
+class hg_arena_scope {
+public:
+  hg_arena_scope(hg_arena_t * a);
+  ~hg_arena_scope();
+private:
+  hg_arena_t * previous;
+  hg_arena_scope(const hg_arena_scope &);
+  hg_arena_scope & operator=(const hg_arena_scope &);
+};
+
+
+template <class T, class U>
+inline bool operator==(const hg_arena_allocator<T> & a, const hg_arena_allocator<U> & b) {
+  return a.arena == b.arena;
+}
+
+template <class T, class U>
+inline bool operator!=(const hg_arena_allocator<T> & a, const hg_arena_allocator<U> & b) {
+  return a.arena != b.arena;
+}
+
+
+#endif /* _HG_ARENA_H */
@@ -0,0 +1,296 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <vector>
+
+#include "hg_checkpoint.h"
+#include "hg_random.h"
+#include "hg_profile.h"
+#include "hg_debug.h"
+
+
+/* A checkpoint is made of two files:
+ *
+ *   <filename>        state, rewritten (atomically) at each checkpoint
+ *     "HGK1"
+ *     n (uint32), T, G, K, Z (double), seed, pair mode, shard, shards (uint32)
+ *     rows done, links, bytes of the links file (uint64)
+ *     random stream state: length (uint32) and text
+ *
+ *   <filename>.links  links, appended at each checkpoint: for each link
+ *     the gap from the previous first node and the gap between its two 
+ *     nodes minus one, as varints (7 bits per byte, least significant
+ *     first)
+ *
+ * The links file is flushed to disk before the state is replaced, 
+ * hence the state always describes a complete prefix of it: after a
+ * crash the bytes beyond that prefix are ignored and overwritten */
+#define HG_CHECKPOINT_MAGIC "HGK1"
+
+struct struct_hg_checkpoint {
+  string filename;
+  string links_filename;
+  FILE * links;
+  double interval;
+  double last;
+  // parameters of the graph
+  uint32_t n;
+  double parameters[4];
+  uint32_t seed;
+  uint32_t pair_mode;
+  uint32_t shard[2];
+  // links saved in the links file
+  uint64_t links_saved;
+  uint64_t links_bytes;
+  int last_id;
+};
+
+
+static double hg_checkpoint_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static inline void hg_checkpoint_put_varint(vector<unsigned char> & out, uint32_t value) {
+  while(value >= 0x80) {
+    out.push_back((unsigned char) (value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((unsigned char) value);
+}
+
+
+static inline bool hg_checkpoint_get_varint(FILE * file, uint32_t & value) {
+  int c, shift = 0;
+  value = 0;
+  do {
+    if((c = fgetc(file)) == EOF || shift > 28) {
+      return false;
+    }
+    value |= (uint32_t) (c & 0x7f) << shift;
+    shift += 7;
+  } while(c & 0x80);
+  return true;
+}
+
+
+static bool hg_checkpoint_read_state(hg_checkpoint_t * c, uint64_t & rows_done,
+				     string & random_state) {
+  FILE * file = fopen(c->filename.c_str(), "rb");
+  if(file == NULL) {
+    hg_log_err("Checkpoint %s cannot be opened", c->filename.c_str());
+    return false;
+  }
+  char magic[4];
+  uint32_t n, seed, pair_mode, shard[2], length = 0;
+  double parameters[4];
+  bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, HG_CHECKPOINT_MAGIC, 4) == 0 &&
+    fread(&n, sizeof(n), 1, file) == 1 && fread(parameters, sizeof(double), 4, file) == 4 &&
+    fread(&seed, sizeof(seed), 1, file) == 1 && fread(&pair_mode, sizeof(pair_mode), 1, file) == 1 &&
+    fread(shard, sizeof(uint32_t), 2, file) == 2 &&
+    fread(&rows_done, sizeof(rows_done), 1, file) == 1 && 
+    fread(&c->links_saved, sizeof(c->links_saved), 1, file) == 1 &&
+    fread(&c->links_bytes, sizeof(c->links_bytes), 1, file) == 1 &&
+    fread(&length, sizeof(length), 1, file) == 1;
+  if(ok) {
+    random_state.resize(length);
+    ok = (length == 0 || fread(&random_state[0], 1, length, file) == length);
+  }
+  fclose(file);
+  if(!ok) {
+    hg_log_err("Checkpoint %s: wrong format", c->filename.c_str());
+    return false;
+  }
+  if(n != c->n || memcmp(parameters, c->parameters, sizeof(parameters)) != 0 ||
+     seed != c->seed || pair_mode != c->pair_mode || memcmp(shard, c->shard, sizeof(shard)) != 0) {
+    hg_log_err("Checkpoint %s belongs to a graph with different parameters", c->filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+/* load the links saved, the rest of the links file is discarded */
+static bool hg_checkpoint_read_links(hg_checkpoint_t * c, hg_link_buffer_t & edges) {
+  FILE * file = fopen(c->links_filename.c_str(), "rb");
+  if(file == NULL) {
+    hg_log_err("Checkpoint %s cannot be opened", c->links_filename.c_str());
+    return false;
+  }
+  uint64_t l;
+  uint32_t gap, distance;
+  int id = 0;
+  edges.reserve(c->links_saved);
+  for(l = 0; l < c->links_saved; l++) {
+    if(!hg_checkpoint_get_varint(file, gap) || !hg_checkpoint_get_varint(file, distance)) {
+      break;
+    }
+    id += gap;
+    edges.push_back(make_pair(id, id + (int) distance + 1));
+  }
+  bool ok = (l == c->links_saved && (uint64_t) ftell(file) == c->links_bytes);
+  fclose(file);
+  if(!ok) {
+    hg_log_err("Checkpoint %s: truncated links", c->links_filename.c_str());
+    return false;
+  }
+  c->last_id = id;
+  return true;
+}
+
+
+hg_checkpoint_t * hg_checkpoint_open(const string filename, const double interval,
+				     const hg_graph_t * graph, const int shard, const int num_shards,
+				     const bool resume, long & rows_done, 
+				     hg_link_buffer_t & edges) {
+  hg_checkpoint_t * c = new hg_checkpoint_t;
+  c->filename = filename;
+  c->links_filename = filename + ".links";
+  c->links = NULL;
+  c->interval = interval;
+  c->last = hg_checkpoint_time();
+  c->n = (*graph)[boost::graph_bundle].expected_n;
+  c->parameters[0] = (*graph)[boost::graph_bundle].temperature;
+  c->parameters[1] = (*graph)[boost::graph_bundle].expected_gamma;
+  c->parameters[2] = (*graph)[boost::graph_bundle].expected_degree;
+  c->parameters[3] = (*graph)[boost::graph_bundle].zeta_eta;
+  c->seed = (*graph)[boost::graph_bundle].seed;
+  c->pair_mode = HG_Random::is_pair_mode();
+  c->shard[0] = shard;
+  c->shard[1] = num_shards;
+  c->links_saved = 0;
+  c->links_bytes = 0;
+  c->last_id = 0;
+  rows_done = 0;
+  if(resume) {
+    uint64_t rows;
+    string random_state;
+    if(!hg_checkpoint_read_state(c, rows, random_state) || !hg_checkpoint_read_links(c, edges)) {
+      delete c;
+      return NULL;
+    }
+    if(!HG_Random::set_state(random_state)) {
+      hg_log_err("Checkpoint %s: wrong random number state", c->filename.c_str());
+      delete c;
+      return NULL;
+    }
+    rows_done = rows;
+    HG_Profile::set("resumed_rows", rows_done);
+    HG_Profile::set("resumed_edges", edges.size());
+  }
+  else {
+    // a previous checkpoint is not valid any more
+    unlink(c->filename.c_str());
+  }
+  // links are appended after the saved ones
+  c->links = fopen(c->links_filename.c_str(), resume ? "r+b" : "wb");
+  if(c->links == NULL || fseek(c->links, c->links_bytes, SEEK_SET) != 0) {
+    hg_log_err("Checkpoint %s cannot be opened", c->links_filename.c_str());
+    hg_checkpoint_close(c, false);
+    return NULL;
+  }
+  return c;
+}
+
+
+bool hg_checkpoint_due(const hg_checkpoint_t * c) {
+  return hg_checkpoint_time() - c->last >= c->interval;
+}
+
+
+bool hg_checkpoint_write(hg_checkpoint_t * c, const long rows_done,
+			 const hg_link_buffer_t & edges) {
+  // new links
+  vector<unsigned char> data;
+  int last_id = c->last_id;
+  size_t e;
+  for(e = c->links_saved; e < edges.size(); e++) {
+    hg_checkpoint_put_varint(data, edges[e].first - c->last_id);
+    hg_checkpoint_put_varint(data, edges[e].second - edges[e].first - 1);
+    c->last_id = edges[e].first;
+  }
+  bool ok = (data.empty() || fwrite(&data[0], 1, data.size(), c->links) == data.size()) &&
+    fflush(c->links) == 0 && fsync(fileno(c->links)) == 0;
+  // then the state
+  string random_state = HG_Random::get_state();
+  uint64_t rows = rows_done;
+  uint64_t links_saved = edges.size();
+  uint64_t links_bytes = c->links_bytes + data.size();
+  uint32_t length = random_state.size();
+  string tmp_filename = c->filename + ".tmp";
+  FILE * file = ok ? fopen(tmp_filename.c_str(), "wb") : NULL;
+  if(file != NULL) {
+    ok = fwrite(HG_CHECKPOINT_MAGIC, 1, 4, file) == 4 &&
+      fwrite(&c->n, sizeof(c->n), 1, file) == 1 && 
+      fwrite(c->parameters, sizeof(double), 4, file) == 4 &&
+      fwrite(&c->seed, sizeof(c->seed), 1, file) == 1 &&
+      fwrite(&c->pair_mode, sizeof(c->pair_mode), 1, file) == 1 &&
+      fwrite(c->shard, sizeof(uint32_t), 2, file) == 2 &&
+      fwrite(&rows, sizeof(rows), 1, file) == 1 && 
+      fwrite(&links_saved, sizeof(links_saved), 1, file) == 1 &&
+      fwrite(&links_bytes, sizeof(links_bytes), 1, file) == 1 &&
+      fwrite(&length, sizeof(length), 1, file) == 1 &&
+      fwrite(random_state.data(), 1, length, file) == length &&
+      fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok && rename(tmp_filename.c_str(), c->filename.c_str()) == 0;
+  }
+  else {
+    ok = false;
+  }
+  if(!ok) {
+    hg_log_err("Checkpoint %s cannot be written", c->filename.c_str());
+    // the previous checkpoint is still valid
+    c->last_id = last_id;
+    fseek(c->links, c->links_bytes, SEEK_SET);
+    return false;
+  }
+  c->links_saved = links_saved;
+  c->links_bytes = links_bytes;
+  c->last = hg_checkpoint_time();
+  return true;
+}
+
+
+void hg_checkpoint_close(hg_checkpoint_t * c, const bool remove) {
+  if(c == NULL) {
+    return;
+  }
+  if(c->links != NULL) {
+    fclose(c->links);
+  }
+  if(remove) {
+    unlink(c->filename.c_str());
+    unlink(c->links_filename.c_str());
+  }
+  delete c;
+}
@@ -0,0 +1,63 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HG_CHECKPOINT_H
+#define _HG_CHECKPOINT_H
+
+#include "hg_formats.h"
+
+
+/* Checkpoints of the link creation (see hg_set_checkpoint): the
+ * rows of the pair space done so far, the state of the random 
+ * number stream and the links created are saved periodically,
+ * so that an interrupted generation can be resumed and produce
+ * the same graph */
+typedef struct struct_hg_checkpoint hg_checkpoint_t;
+
+/* open the checkpoint of the generation of graph (whose parameters
+ * and coordinates are set), or of its shard (see hg_set_shard). If
+ * resume is true the last checkpoint
+ * is loaded: the rows done are returned in rows_done, the links in
+ * edges and the random stream is restored. NULL if the checkpoint
+ * cannot be written, or read, or it belongs to another graph */
+hg_checkpoint_t * hg_checkpoint_open(const string filename, const double interval,
+				     const hg_graph_t * graph, const int shard, const int num_shards,
+				     const bool resume, long & rows_done, 
+				     hg_link_buffer_t & edges);
+
+/* true if the interval since the last checkpoint has elapsed */
+bool hg_checkpoint_due(const hg_checkpoint_t * c);
+
+/* save a checkpoint: rows_done rows have been completed and edges
+ * contains all their links (only the new ones are written) */
+bool hg_checkpoint_write(hg_checkpoint_t * c, const long rows_done,
+			 const hg_link_buffer_t & edges);
+
+/* close the checkpoint, its files are removed if remove is true */
+void hg_checkpoint_close(hg_checkpoint_t * c, const bool remove);
+
+
+#endif /* _HG_CHECKPOINT_H */
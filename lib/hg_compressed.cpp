@@ -0,0 +1,449 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+#include "hg_graphs_lib.h"
+#include "hg_utils.h"
+#include "hg_debug.h"
+
+
+/* Compressed .hgc format (all the numbers are little endian):
+ *
+ *   "HGC1"
+ *   n (uint32), T, G, K, Z (double), seed, starting id (uint32)
+ *   block size, number of blocks (uint32)
+ *   coordinates: r, theta (double) of each node
+ *   offsets of the blocks in the adjacency (uint64, blocks + 1)
+ *   adjacency
+ *
+ * The adjacency lists the neighbours of each node: the degree, then
+ * the neighbours sorted by id, the first one as the zigzag encoded 
+ * difference from the node id, the others as the gap from the 
+ * previous one. Every number is a varint (7 bits per byte, the high
+ * bit set on all the bytes but the last). Nodes are grouped in blocks
+ * of block size nodes, a block can be decoded alone, hence the
+ * neighbours of a node are read without decoding the whole file.
+ */
+
+#define HG_COMPRESSED_MAGIC "HGC1"
+#define HG_COMPRESSED_BLOCK_SIZE 256
+
+
+/* ================= encoding  ================= */
+
+
+static inline void hg_put_varint(vector<unsigned char> & out, uint64_t value) {
+  while(value >= 0x80) {
+    out.push_back((unsigned char) (value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((unsigned char) value);
+}
+
+
+static inline void hg_put_uint32(vector<unsigned char> & out, const uint32_t value) {
+  int b;
+  for(b = 0; b < 4; b++) {
+    out.push_back((unsigned char) (value >> (8 * b)));
+  }
+}
+
+
+static inline void hg_put_uint64(vector<unsigned char> & out, const uint64_t value) {
+  int b;
+  for(b = 0; b < 8; b++) {
+    out.push_back((unsigned char) (value >> (8 * b)));
+  }
+}
+
+
+static inline void hg_put_double(vector<unsigned char> & out, const double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  hg_put_uint64(out, bits);
+}
+
+
+bool hg_print_compressed_graph(const hg_graph_t * g, const string filename) {
+  if(g == NULL) {
+    hg_log_err("Warning: empty data structure, no file written");
+    return false;
+  }
+  FILE * file = fopen(filename.c_str(), "wb");
+  if(file == NULL) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return false;
+  }
+  hg_csr_t * csr = hg_get_csr(g);
+  uint32_t n = num_vertices(*g);
+  uint32_t num_blocks = (n + HG_COMPRESSED_BLOCK_SIZE - 1) / HG_COMPRESSED_BLOCK_SIZE;
+  // adjacency
+  vector<unsigned char> adjacency;
+  adjacency.reserve(csr->neighbours.size() + 2 * n);
+  vector<uint64_t> offsets;
+  offsets.reserve(num_blocks + 1);
+  uint32_t id;
+  size_t i;
+  for(id = 0; id < n; id++) {
+    if(id % HG_COMPRESSED_BLOCK_SIZE == 0) {
+      offsets.push_back(adjacency.size());
+    }
+    hg_put_varint(adjacency, csr->offsets[id+1] - csr->offsets[id]);
+    for(i = csr->offsets[id]; i < csr->offsets[id+1]; i++) {
+      if(i == csr->offsets[id]) {
+	int64_t diff = (int64_t) csr->neighbours[i] - (int64_t) id;
+	hg_put_varint(adjacency, (uint64_t) ((diff << 1) ^ (diff >> 63)));
+      }
+      else {
+	hg_put_varint(adjacency, csr->neighbours[i] - csr->neighbours[i-1]);
+      }
+    }
+  }
+  offsets.push_back(adjacency.size());
+  delete csr;
+  // header, coordinates and offsets
+  vector<unsigned char> head;
+  head.insert(head.end(), HG_COMPRESSED_MAGIC, HG_COMPRESSED_MAGIC + 4);
+  hg_put_uint32(head, n);
+  hg_put_double(head, (*g)[boost::graph_bundle].temperature);
+  hg_put_double(head, (*g)[boost::graph_bundle].expected_gamma);
+  hg_put_double(head, (*g)[boost::graph_bundle].expected_degree);
+  hg_put_double(head, (*g)[boost::graph_bundle].zeta_eta);
+  hg_put_uint32(head, (*g)[boost::graph_bundle].seed);
+  hg_put_uint32(head, (*g)[boost::graph_bundle].starting_id);
+  hg_put_uint32(head, HG_COMPRESSED_BLOCK_SIZE);
+  hg_put_uint32(head, num_blocks);
+  for(id = 0; id < n; id++) {
+    hg_put_double(head, (*g)[id].r);
+    hg_put_double(head, (*g)[id].theta);
+  }
+  for(i = 0; i < offsets.size(); i++) {
+    hg_put_uint64(head, offsets[i]);
+  }
+  bool ok = fwrite(&head[0], 1, head.size(), file) == head.size();
+  if(ok && !adjacency.empty()) {
+    ok = fwrite(&adjacency[0], 1, adjacency.size(), file) == adjacency.size();
+  }
+  fclose(file);
+  if(!ok) {
+    hg_log_err("File %s cannot be written", filename.c_str());
+  }
+  return ok;
+}
+
+
+/* ================= decoding  ================= */
+
+
+/* bounds checked reader of a memory buffer */
+typedef struct struct_hg_buffer_reader {
+  const unsigned char * data;
+  size_t len;
+  size_t pos;
+  bool error;
+} hg_buffer_reader_t;
+
+
+static inline uint64_t hg_get_varint(hg_buffer_reader_t & b) {
+  uint64_t value = 0;
+  int shift = 0;
+  while(b.pos < b.len && shift < 64) {
+    unsigned char c = b.data[b.pos++];
+    value |= (uint64_t) (c & 0x7f) << shift;
+    if((c & 0x80) == 0) {
+      return value;
+    }
+    shift += 7;
+  }
+  b.error = true;
+  return 0;
+}
+
+
+static inline uint64_t hg_get_bytes(hg_buffer_reader_t & b, const int bytes) {
+  if(b.pos + bytes > b.len) {
+    b.error = true;
+    return 0;
+  }
+  uint64_t value = 0;
+  int i;
+  for(i = 0; i < bytes; i++) {
+    value |= (uint64_t) b.data[b.pos++] << (8 * i);
+  }
+  return value;
+}
+
+
+static inline double hg_get_double(hg_buffer_reader_t & b) {
+  uint64_t bits = hg_get_bytes(b, 8);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+
+/* neighbours of node id, the reader is at the beginning of its list */
+static inline void hg_get_neighbours(hg_buffer_reader_t & b, const uint32_t id, 
+				     vector<unsigned int> & neighbours) {
+  uint64_t degree = hg_get_varint(b);
+  uint64_t d;
+  int64_t v = 0;
+  neighbours.clear();
+  for(d = 0; d < degree && !b.error; d++) {
+    uint64_t x = hg_get_varint(b);
+    if(d == 0) {
+      v = (int64_t) id + (int64_t) ((x >> 1) ^ (~(x & 1) + 1));
+    }
+    else {
+      v += x;
+    }
+    neighbours.push_back((unsigned int) v);
+  }
+}
+
+
+/* header of the file, up to the offsets (included) */
+static bool hg_get_header(hg_buffer_reader_t & b, hg_parameters_t & par, uint32_t & block_size,
+			  vector<hg_coordinate_t> * coordinates, vector<uint64_t> & offsets) {
+  if(b.len < 4 || memcmp(b.data, HG_COMPRESSED_MAGIC, 4) != 0) {
+    return false;
+  }
+  b.pos = 4;
+  uint32_t n = hg_get_bytes(b, 4);
+  par.expected_n = n;
+  par.temperature = hg_get_double(b);
+  par.expected_gamma = hg_get_double(b);
+  par.expected_degree = hg_get_double(b);
+  par.zeta_eta = hg_get_double(b);
+  par.seed = (int) hg_get_bytes(b, 4);
+  par.starting_id = hg_get_bytes(b, 4);
+  par.type = hg_infer_hg_type(par.expected_gamma, par.temperature);
+  block_size = hg_get_bytes(b, 4);
+  uint32_t num_blocks = hg_get_bytes(b, 4);
+  if(b.error || block_size == 0 || num_blocks != (n + block_size - 1) / block_size) {
+    return false;
+  }
+  uint32_t id;
+  if(coordinates != NULL) {
+    coordinates->resize(n);
+  }
+  for(id = 0; id < n && !b.error; id++) {
+    double r = hg_get_double(b);
+    double theta = hg_get_double(b);
+    if(coordinates != NULL) {
+      (*coordinates)[id].r = r;
+      (*coordinates)[id].theta = theta;
+    }
+  }
+  offsets.resize(num_blocks + 1);
+  for(id = 0; id <= num_blocks && !b.error; id++) {
+    offsets[id] = hg_get_bytes(b, 8);
+  }
+  return !b.error;
+}
+
+
+static bool hg_read_file(const string filename, vector<unsigned char> & content) {
+  FILE * file = fopen(filename.c_str(), "rb");
+  if(file == NULL) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  content.resize(size > 0 ? size : 0);
+  bool ok = size >= 0 && (size == 0 || fread(&content[0], 1, size, file) == (size_t) size);
+  fclose(file);
+  return ok;
+}
+
+
+hg_graph_t * hg_read_compressed_graph(const string filename, bool read_links) {
+  vector<unsigned char> content;
+  if(!hg_read_file(filename, content)) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return NULL;
+  }
+  hg_buffer_reader_t b = { content.empty() ? NULL : &content[0], content.size(), 0, false };
+  hg_parameters_t par;
+  uint32_t block_size;
+  vector<hg_coordinate_t> coordinates;
+  vector<uint64_t> offsets;
+  if(!hg_get_header(b, par, block_size, &coordinates, offsets)) {
+    hg_log_err("File %s: wrong header", filename.c_str());
+    return NULL;
+  }
+  uint32_t n = par.expected_n;
+  hg_graph_t * g = hg_create_graph(n);
+  (*g)[boost::graph_bundle] = par;
+  uint32_t id;
+  for(id = 0; id < n; id++) {
+    (*g)[id] = coordinates[id];
+  }
+  if(!read_links) {
+    return g;
+  }
+  // each link is added once, from its lower id endpoint
+  size_t data_start = b.pos;
+  vector<unsigned int> neighbours;
+  hg_link_buffer_t links;
+  size_t i;
+  for(id = 0; id < n && !b.error; id++) {
+    hg_get_neighbours(b, id, neighbours);
+    for(i = 0; i < neighbours.size(); i++) {
+      if(neighbours[i] >= n) {
+	b.error = true;
+      }
+      else if(neighbours[i] > id) {
+	links.push_back(make_pair(id, neighbours[i]));
+      }
+    }
+  }
+  if(b.error || b.pos - data_start != offsets.back()) {
+    hg_log_err("File %s: wrong adjacency", filename.c_str());
+    delete g;
+    return NULL;
+  }
+  hg_add_edges(g, links);
+  return g;
+}
+
+
+/* ================= random access  ================= */
+
+
+struct struct_hg_compressed {
+  FILE * file;
+  hg_parameters_t par;
+  vector<hg_coordinate_t> coordinates;
+  uint32_t block_size;
+  vector<uint64_t> offsets;
+  long data_start;
+  // last block decoded, and where its next node starts
+  long cached_block;
+  vector<unsigned char> block;
+  uint32_t next_node;
+  size_t next_pos;
+};
+
+
+hg_compressed_t * hg_compressed_open(const string filename, hg_parameters_t & par) {
+  FILE * file = fopen(filename.c_str(), "rb");
+  if(file == NULL) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return NULL;
+  }
+  // fixed size part of the header, then coordinates and offsets
+  vector<unsigned char> head(56);
+  bool ok = fread(&head[0], 1, head.size(), file) == head.size();
+  hg_buffer_reader_t b = { &head[0], head.size(), 0, false };
+  if(ok) {
+    b.pos = 4;
+    uint32_t n = hg_get_bytes(b, 4);
+    b.pos = 48;
+    uint32_t block_size = hg_get_bytes(b, 4);
+    uint32_t num_blocks = hg_get_bytes(b, 4);
+    size_t size = head.size() + 16 * (size_t) n + 8 * ((size_t) num_blocks + 1);
+    head.resize(size);
+    ok = block_size > 0 && 
+      fread(&head[56], 1, size - 56, file) == size - 56;
+  }
+  hg_compressed_t * c = new hg_compressed_t;
+  b.data = &head[0];
+  b.len = head.size();
+  b.pos = 0;
+  if(!ok || !hg_get_header(b, c->par, c->block_size, &c->coordinates, c->offsets)) {
+    hg_log_err("File %s: wrong header", filename.c_str());
+    fclose(file);
+    delete c;
+    return NULL;
+  }
+  c->file = file;
+  c->data_start = head.size();
+  c->cached_block = -1;
+  c->next_node = 0;
+  c->next_pos = 0;
+  par = c->par;
+  return c;
+}
+
+
+bool hg_compressed_coordinate(const hg_compressed_t * c, const unsigned int id,
+			      hg_coordinate_t & coordinate) {
+  if(id >= c->coordinates.size()) {
+    return false;
+  }
+  coordinate = c->coordinates[id];
+  return true;
+}
+
+
+bool hg_compressed_neighbours(hg_compressed_t * c, const unsigned int id,
+			      vector<unsigned int> & neighbours) {
+  neighbours.clear();
+  if(id >= c->coordinates.size()) {
+    return false;
+  }
+  long block = id / c->block_size;
+  if(block != c->cached_block || id < c->next_node) {
+    size_t size = c->offsets[block+1] - c->offsets[block];
+    c->block.resize(size);
+    c->cached_block = -1;
+    if(fseek(c->file, c->data_start + c->offsets[block], SEEK_SET) != 0 ||
+       (size > 0 && fread(&c->block[0], 1, size, c->file) != size)) {
+      return false;
+    }
+    c->cached_block = block;
+    c->next_node = block * c->block_size;
+    c->next_pos = 0;
+  }
+  // nodes read in id order are decoded once
+  hg_buffer_reader_t b = { c->block.empty() ? NULL : &c->block[0], c->block.size(), c->next_pos, false };
+  uint32_t node;
+  for(node = c->next_node; node <= id && !b.error; node++) {
+    hg_get_neighbours(b, node, neighbours);
+  }
+  if(b.error) {
+    c->cached_block = -1;
+    return false;
+  }
+  c->next_node = id + 1;
+  c->next_pos = b.pos;
+  return true;
+}
+
+
+void hg_compressed_close(hg_compressed_t * c) {
+  if(c == NULL) {
+    return;
+  }
+  fclose(c->file);
+  delete c;
+}
@@ -0,0 +1,170 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifdef HG_PERF_EVENT
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "hg_counters.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+static const char * hg_counter_names[HG_NUM_COUNTERS] = {
+  "pairs",
+  "rng_draws",
+  "acosh_calls",
+  "exp_calls",
+  "edges",
+  "routing_hops",
+  "neighbour_scans",
+  "compact_rechecks"
+};
+
+
+const char * hg_counter_name(const int c) {
+  if(c < 0 || c >= HG_NUM_COUNTERS) {
+    return "unknown";
+  }
+  return hg_counter_names[c];
+}
+
+
+#ifdef HG_COUNTERS_ON
+
+__thread hg_counters_t * hg_local_counters = NULL;
+
+/* the counters of each thread are never deallocated, so
+ * that the values of the threads that have already 
+ * terminated are still part of the total */
+static vector<hg_counters_t *> * hg_all_counters = NULL;
+
+
+static void hg_counters_print() {
+  hg_counters_t total = hg_counters_get();
+  int c;
+  for(c = 0; c < HG_NUM_COUNTERS; c++) {
+    fprintf(stderr, "[COUNTER] %s\t%llu\n", hg_counter_name(c), total.value[c]);
+  }
+}
+
+
+hg_counters_t * hg_counters_register() {
+  hg_counters_t * counters = new hg_counters_t;
+  memset(counters, 0, sizeof(hg_counters_t));
+#pragma omp critical (hg_counters)
+  {
+    if(hg_all_counters == NULL) {
+      hg_all_counters = new vector<hg_counters_t *>;
+      atexit(hg_counters_print);
+    }
+    hg_all_counters->push_back(counters);
+  }
+  hg_local_counters = counters;
+  return counters;
+}
+
+#endif
+
+
+hg_counters_t hg_counters_get() {
+  hg_counters_t total;
+  memset(&total, 0, sizeof(hg_counters_t));
+#ifdef HG_COUNTERS_ON
+#pragma omp critical (hg_counters)
+  {
+    if(hg_all_counters != NULL) {
+      unsigned int i;
+      int c;
+      for(i = 0; i < hg_all_counters->size(); i++) {
+	for(c = 0; c < HG_NUM_COUNTERS; c++) {
+	  total.value[c] += (*hg_all_counters)[i]->value[c];
+	}
+      }
+    }
+  }
+#endif
+  return total;
+}
+
+
+#ifdef HG_PERF_EVENT
+
+/* the events are opened once, and inherited by the threads
+ * created afterwards (their values are added to the process
+ * counts when they terminate) */
+static int hg_perf_fd[2] = {-2, -2};
+
+static int hg_perf_open(const unsigned long long config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  if(fd < 0) {
+    hg_debug("perf_event not available: %s", hg_clean_errno());
+  }
+  return fd;
+}
+
+static long long hg_perf_value(const int fd) {
+  long long value;
+  if(fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+    return -1;
+  }
+  return value;
+}
+
+#endif
+
+
+hg_perf_sample_t hg_perf_read() {
+  hg_perf_sample_t sample;
+  sample.cycles = -1;
+  sample.cache_misses = -1;
+#ifdef HG_PERF_EVENT
+  if(hg_perf_fd[0] == -2) {
+    hg_perf_fd[0] = hg_perf_open(PERF_COUNT_HW_CPU_CYCLES);
+    hg_perf_fd[1] = hg_perf_open(PERF_COUNT_HW_CACHE_MISSES);
+  }
+  sample.cycles = hg_perf_value(hg_perf_fd[0]);
+  sample.cache_misses = hg_perf_value(hg_perf_fd[1]);
+#endif
+  return sample;
+}
@@ -0,0 +1,101 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _HG_COUNTERS_H
+#define _HG_COUNTERS_H
+
+#include <string>
+
+
+/* Hot-path event counters. They are compiled only when the
+ * package is configured with --enable-counters (that defines
+ * HG_COUNTERS_ON), otherwise hg_count() expands to nothing.
+ * Every thread increments its own counters, the values of 
+ * all the threads are summed by hg_counters_get() and 
+ * printed on stderr when the program exits.
+ */
+
+typedef enum {
+  HG_COUNTER_PAIRS = 0,          // pairs of nodes evaluated
+  HG_COUNTER_RNG_DRAWS,          // random numbers extracted
+  HG_COUNTER_ACOSH,              // acosh calls
+  HG_COUNTER_EXP,                // exp calls
+  HG_COUNTER_EDGES,              // edges created
+  HG_COUNTER_ROUTING_HOPS,       // greedy routing hops
+  HG_COUNTER_NEIGHBOUR_SCANS,    // neighbours examined while routing
+  HG_COUNTER_RECHECKS,           // pairs re-checked in double precision (compact mode)
+  HG_NUM_COUNTERS
+} hg_counter_t;
+
+
+typedef struct struct_hg_counters {
+  unsigned long long value[HG_NUM_COUNTERS];
+} hg_counters_t;
+
+
+#ifdef HG_COUNTERS_ON
+
+extern __thread hg_counters_t * hg_local_counters;
+
+// allocate (and register) the counters of the calling thread
+hg_counters_t * hg_counters_register();
+
+#define hg_count_n(C, N) do {						\
+    hg_counters_t * hg_c = hg_local_counters;				\
+    if(hg_c == NULL) { hg_c = hg_counters_register(); }		\
+    hg_c->value[(C)] += (N);						\
+  } while(0)
+
+#else
+
+#define hg_count_n(C, N)
+
+#endif
+
+#define hg_count(C) hg_count_n(C, 1)
+
+
+// name of a counter (used in the reports)
+const char * hg_counter_name(const int c);
+
+// sum of the counters of all the threads (zero if disabled)
+hg_counters_t hg_counters_get();
+
+
+/* hardware events sampled through Linux perf_event 
+ * (cycles and cache misses of the process), available 
+ * when the counters are enabled and the kernel allows it;
+ * values are -1 otherwise */
+typedef struct struct_hg_perf_sample {
+  long long cycles;
+  long long cache_misses;
+} hg_perf_sample_t;
+
+hg_perf_sample_t hg_perf_read();
+
+
+#endif /* _HG_COUNTERS_H */
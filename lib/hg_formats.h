@@ -29,9 +29,15 @@
 #define _HG_FORMATS_H
 
 #include <iostream>
+#include <vector>
+#include <set>
+#include <list>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/exterior_property.hpp>
 
+#include "hg_alloc.h"
+#include "hg_arena.h"
+
 using namespace std;
 
 // constants definition
@@ -49,6 +55,9 @@ typedef struct struct_hg_coordinate {
   double theta; // angular coordinate, angular distance from a reference point
 } hg_coordinate_t;
 
+/* coordinates of all the nodes (see hg_alloc.h) */
+typedef vector<hg_coordinate_t, hg_allocator<hg_coordinate_t> > hg_coordinate_array_t;
+
 typedef enum {
   HYPERBOLIC_RGG,
   HYPERBOLIC_STANDARD,
@@ -93,8 +102,36 @@ typedef struct struct_f_params{
 } hg_f_params;
   
 
+/* container selectors of the graph: the same containers as
+ * boost::setS and boost::listS, with their nodes allocated in
+ * the default arena of the thread when they are built, an arena
+ * of the graph when it is built by hg_create_graph (hg_utils.h),
+ * freed when the graph is destroyed (see hg_arena.h) */
+struct hg_setS {};
+struct hg_listS {};
+
+namespace boost {
+  template <class ValueType>
+  struct container_gen<hg_setS, ValueType> {
+    typedef std::set<ValueType, std::less<ValueType>, hg_arena_allocator<ValueType> > type;
+  };
+  template <class ValueType>
+  struct container_gen<hg_listS, ValueType> {
+    typedef std::list<ValueType, hg_arena_allocator<ValueType> > type;
+  };
+  template <>
+  struct parallel_edge_traits<hg_setS> {
+    typedef disallow_parallel_edge_tag type;
+  };
+  template <>
+  struct parallel_edge_traits<hg_listS> {
+    typedef allow_parallel_edge_tag type;
+  };
+}
+
+
 /* customized boost graph */
-typedef boost::adjacency_list<boost::setS, /* container for the edgelist
+typedef boost::adjacency_list<hg_setS,     /* container for the edgelist
 					    * for each of the vertices
 					    * - no duplicate edges */
                               boost::vecS, /* container for vertexlist
@@ -102,8 +139,45 @@ typedef boost::adjacency_list<boost::setS, /* container for the edgelist
                               boost::undirectedS, /* undirected graph selector */
                               hg_coordinate_t,    /* vertex coordinate */
                               boost::no_property, /* edge properties */
-                              hg_parameters_t     /* graph parameters */
+                              hg_parameters_t,    /* graph parameters */
+                              hg_listS            /* container for the edges */
                               > hg_graph_t;
 
 
+/* Compressed sparse row (CSR) adjacency of a hg_graph_t:
+ * the neighbours of node id are sorted by id and stored in
+ * neighbours[offsets[id]] ... neighbours[offsets[id+1]-1]
+ * (the arrays follow the allocation policy, see hg_alloc.h) */
+typedef struct struct_hg_csr {
+  vector<size_t, hg_allocator<size_t> > offsets;
+  vector<unsigned int, hg_allocator<unsigned int> > neighbours;
+} hg_csr_t;
+
+
+/* Order of the node ids after a relabelling (see hg_relabel_graph):
+ * by angular coordinate, or along a Hilbert curve in (theta, r) */
+typedef enum {
+  HG_ORDER_ANGLE,
+  HG_ORDER_HILBERT
+} hg_node_order;
+
+
+/* Sequential reader of a .hg file (see hg_stream.cpp) */
+typedef struct struct_hg_stream hg_stream_t;
+
+
+/* Random access reader of a compressed .hgc file (see hg_compressed.cpp) */
+typedef struct struct_hg_compressed hg_compressed_t;
+
+
+/* Spatial index over the coordinates of a graph
+ * (see hg_quadtree_build), the struct is opaque */
+typedef struct struct_hg_quadtree hg_quadtree_t;
+
+
+/* Graph of a threshold model whose links are computed from the
+ * coordinates when needed (see hg_implicit_graph_create) */
+typedef struct struct_hg_implicit_graph hg_implicit_graph_t;
+
+
 #endif /* _HG_FORMATS_H */
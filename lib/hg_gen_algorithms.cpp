@@ -27,48 +27,43 @@
 
 #include <assert.h>     /* assert */
 #include <limits>
+#include <algorithm>
 
+#include "hg_graphs_lib.h"
 #include "hg_gen_algorithms.h"
 #include "hg_utils.h"
 #include "hg_random.h"
 #include "hg_math.h"
+#include "hg_profile.h"
+#include "hg_counters.h"
+#include "hg_pipeline.h"
+#include "hg_checkpoint.h"
+#include "hg_scheduler.h"
 #include "hg_debug.h"
 
 
 /* ================= graph construction utilities ================= */
 
 
-/* r_precomputedsinhcosh is a structure that contains the precomputed values
- * of sinh(zeta * r) and cosh(zeta * r) for each value of r. It is an
- * STL map:
- *         <r, < sinh(zeta*r), cosh(zeta*r) > >  
- * this structure does not need to be exported outside this coding unit
- */
-typedef map<double, pair<double,double> > r_precomputedsinhcosh;
-
-
+/* assign coordinates to the nodes in [first_id, num_vertices) */
 static void hg_assign_coordinates(hg_graph_t * graph, const hg_algorithm_parameters_t & in_par,
-				  r_precomputedsinhcosh * r_psc = NULL) {
+				  const int first_id = 0) {
   hg_debug("\tAssigning coordinates");
   int id; // node identifier [0,n-1]
+  int n = num_vertices(*graph);
   switch((*graph)[boost::graph_bundle].type){
   case HYPERBOLIC_RGG: 
   case HYPERBOLIC_STANDARD:
   case SOFT_CONFIGURATION_MODEL:
-    for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-      double zeta = (*graph)[boost::graph_bundle].zeta_eta;
-      double r = hg_quasi_uniform_radial_coordinate(in_par.radius, in_par.alpha);
-      (*graph)[id].r = r;
-      if(r_psc != NULL) {
-	(*r_psc).insert(make_pair(r, make_pair(sinh(zeta * r), cosh(zeta * r))));
-      }
+    for(id = first_id; id < n; id++) {
+      (*graph)[id].r = hg_quasi_uniform_radial_coordinate(in_par.radius, in_par.alpha);
       (*graph)[id].theta = hg_uniform_angular_coordinate();
     }
     break;
   case ANGULAR_RGG:
   case SOFT_RGG:
   case ERDOS_RENYI:
-    for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
+    for(id = first_id; id < n; id++) {
       (*graph)[id].r = in_par.radius; // HG_INF_RADIUS
       (*graph)[id].theta = hg_uniform_angular_coordinate();
     }
@@ -113,13 +108,59 @@ static double hg_get_lambda_from_Gauss_hypergeometric_function(hg_graph_t * grap
 }
 
 
-/* ================= single model graph generators  ================= */
+/* internal parameters of the model, computed from the
+ * parameters in the graph bundle */
+static void hg_get_internal_parameters(hg_graph_t * graph, hg_algorithm_parameters_t & p) {
+  hg_debug("\tInternal parameters computation");
+  double zeta_eta = (*graph)[boost::graph_bundle].zeta_eta;
+  double exp_gamma = (*graph)[boost::graph_bundle].expected_gamma;
+  double temperature = (*graph)[boost::graph_bundle].temperature;
+  p.radius = HG_INF_RADIUS;
+  p.alpha = -1; // not relevant for angular models
+  p.eta = -1;   // not relevant for all models but scm
+  p.c = -1;     // not relevant for all models but soft_rgg
+  switch((*graph)[boost::graph_bundle].type){
+  case HYPERBOLIC_RGG:
+    p.alpha = 0.5 * zeta_eta * (exp_gamma-1.0);
+    p.radius = hg_get_R_from_numerical_integration(graph, p);
+    break;
+  case HYPERBOLIC_STANDARD:
+    // alpha calculation. different for cold and hot regimes
+    if(temperature <= 1) {
+      p.alpha = 0.5 * zeta_eta * (exp_gamma-1.0);
+    }
+    else {
+      p.alpha = 0.5 * zeta_eta/temperature * (exp_gamma-1.0);
+    }
+    p.radius = hg_get_R_from_numerical_integration(graph, p);
+    break;
+  case SOFT_CONFIGURATION_MODEL:
+    // zeta goes to infinity
+    //(*graph)[boost::graph_bundle].zeta_eta = numeric_limits<double>::max( );
+    p.eta = zeta_eta;
+    p.alpha = 0.5 * p.eta * (exp_gamma-1.0);
+    p.radius = hg_get_R_from_numerical_integration(graph, p);
+    break;
+  case ANGULAR_RGG:
+  case ERDOS_RENYI:
+    break;
+  case SOFT_RGG:
+    p.c = hg_get_lambda_from_Gauss_hypergeometric_function(graph,p); 
+    break;
+  default:
+    hg_log_err("Case not implemented.");
+  }
+  hg_debug("\tInternal parameters:");
+  hg_debug("\t\tAlpha: %f", p.alpha);
+  hg_debug("\t\tEta: %f", p.eta);
+  hg_debug("\t\tRadius: %f", p.radius);
+  hg_debug("\t\tLambda: %f", p.c);
+}
 
 
 inline double hg_hyperbolic_distance_hyperbolic_rgg_standard(const hg_graph_t * graph,
 							     const hg_coordinate_t & node1, 
-							     const hg_coordinate_t & node2,
-							     r_precomputedsinhcosh * r_psc = NULL) {
+							     const hg_coordinate_t & node2) {
   // check if it is the same node
   if(node1.r == node2.r && node1.theta == node2.theta) {
     return 0;
@@ -132,234 +173,807 @@ inline double hg_hyperbolic_distance_hyperbolic_rgg_standard(const hg_graph_t *
   // equation 13
   double zeta = (*graph)[boost::graph_bundle].zeta_eta;
   double delta_theta = HG_PI - abs(HG_PI - abs(node1.theta - node2.theta));
-  double part1, part2;
-  if(r_psc != NULL) {
-    part1 = (*r_psc)[node1.r].second * (*r_psc)[node2.r].second;
-    part2 = (*r_psc)[node1.r].first  * (*r_psc)[node2.r].first  * cos(delta_theta);
+  double part1 = cosh(zeta * node1.r) * cosh(zeta * node2.r);
+  double part2 = sinh(zeta * node1.r) * sinh(zeta * node2.r) * cos(delta_theta);
+  hg_count(HG_COUNTER_ACOSH);
+  return  acosh(part1 - part2) / zeta;
+}
+
+
+static double hg_hyperbolic_distance_scm(const hg_graph_t * graph,
+					 const hg_coordinate_t & node1, 
+					 const hg_coordinate_t & node2) {
+  // check if it is the same node
+  if(node1.r == node2.r && node1.theta == node2.theta) {
+    return 0;
   }
-  else {    
-    part1 = cosh(zeta * node1.r) * cosh(zeta * node2.r);
-    part2 = sinh(zeta * node1.r) * sinh(zeta * node2.r) * cos(delta_theta);
+  // curvature is infinite, so 1/zeta goes to zero  
+  return node1.r + node2.r;
+}
+
+
+static double hg_hyperbolic_distance_angular_soft_rgg(const hg_graph_t * graph,
+						      const hg_coordinate_t & node1, 
+						      const hg_coordinate_t & node2) {
+  // check if it is the same node
+  if(node1.r == node2.r && node1.theta == node2.theta) {
+    return 0;
   }
-  return  acosh(part1 - part2) / zeta;
+  // delta theta
+  return HG_PI - abs(HG_PI - abs(node1.theta - node2.theta));
 }
 
 
-static double hg_connection_probability_hyperbolic_rgg(const hg_graph_t * graph,
-						       const hg_algorithm_parameters_t & p,
-						       const hg_coordinate_t & node1, 
-						       const hg_coordinate_t & node2,
-						       r_precomputedsinhcosh * r_psc = NULL) {
-  // equation 32: Heaviside function
-  if(hg_hyperbolic_distance_hyperbolic_rgg_standard(graph, node1, node2, r_psc) <= p.radius) {
-    return 1;
+static double hg_hyperbolic_distance_er(const hg_graph_t * graph,
+					const hg_coordinate_t & node1, 
+					const hg_coordinate_t & node2) {
+  // check if it is the same node
+  if(node1.r == node2.r && node1.theta == node2.theta) {
+    return 0;
   }
-  return 0;
+  // there is no "real distance", indeed!
+  return 1; 
 }
 
 
-hg_graph_t * hg_hyperbolic_rgg(const int n, const double k_bar, 
-			       const double exp_gamma,
-			       const double zeta, const int seed, 
-			       bool verbose) {
-  if(verbose) {
-    cout << "-> Hyperbolic Random Geometric Graph" << endl << endl;
+/* ================= model policies  ================= */
+
+
+/* A model policy captures by value the constants of a model
+ * (read once from the graph bundle and the internal parameters)
+ * and provides the connection probability of the pair (i,j):
+ *
+ *   Model(const hg_graph_t * graph, const hg_algorithm_parameters_t & p);
+ *   double probability(i, node_i, j, node_j) const;
+ *   double max_angle(node, r) const;
+ *   static const bool threshold;
+ *   bool compact(graph);
+ *   bool is_compact() const;
+ *   int compact_link(i, j) const;
+ *
+ * max_angle is an upper bound of the angular distance at which a
+ * node having radial coordinate >= r can be linked to node, it is
+ * used when a graph grows (see hg_graph_grow) to visit only the
+ * candidate pairs of threshold models (probability either 0 or 1);
+ * every pair can be linked in the other models (max_angle = pi).
+ *
+ * In compact mode (see hg_set_compact) threshold models keep 32-bit
+ * float copies of the coordinates: compact_link decides a pair on
+ * them (1 linked, 0 not linked) when the expression compared with
+ * the threshold is farther from it than HG_COMPACT_TOLERANCE (relative),
+ * otherwise it returns -1 and the pair is evaluated by probability.
+ * The other models inherit the defaults of hg_policy (no compact mode).
+ *
+ * hg_create_links is instantiated for each policy, hence the
+ * inner loop of every model is inlined and has no switch on
+ * the graph type. Each policy computes exactly the same 
+ * expressions of the equations referenced below.
+ */
+
+
+/* float rounding of the coordinates and of the products (about 1e-7)
+ * and of cos(dtheta) (about 1e-6 as theta is up to 2 pi) is well 
+ * below the tolerance */
+#define HG_COMPACT_TOLERANCE 1e-5f
+
+
+class hg_policy {
+public:
+  bool compact(const hg_graph_t * graph) {
+    return false;
   }
-  hg_graph_t * graph = new hg_graph_t(n);
-  if(graph == NULL) {
-    hg_log_warn("Unable to allocate memory for graph object");
-    return NULL;
+  inline bool is_compact() const {
+    return false;
   }
-  // init graph
-  hg_init_graph(graph, n, k_bar, exp_gamma, 0 /* t = 0 */,
-		zeta, seed, HYPERBOLIC_RGG);
-  // computing internal parameters
-  hg_debug("\tInternal parameters computation");
-  hg_algorithm_parameters_t p;
-  p.alpha = 0.5 * zeta * (exp_gamma-1.0);
-  p.eta = -1; // not relevant for current model
-  p.c = -1;  // not relevant for current model
-  p.radius = hg_get_R_from_numerical_integration(graph, p);
-  r_precomputedsinhcosh r_psc; 
-  hg_assign_coordinates(graph, p, &r_psc);
-  hg_coordinate_t c1, c2;
-  int id, other_id;
-  hg_debug("\tInternal parameters:");
-  hg_debug("\t\tAlpha: %f", p.alpha);
-  hg_debug("\t\tRadius: %f", p.radius);
-  hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);
-      if(HG_Random::get_random_01_value() < hg_connection_probability_hyperbolic_rgg(graph, p, c1, c2, &r_psc)){
-	add_edge(id, other_id, *graph);
-	//hg_debug("\t\tNew link: %d - %d ", id, other_id);
+  inline int compact_link(const int i, const int j) const {
+    return -1;
+  }
+};
+
+
+/* hyperbolic distance (equation 13), sinh(zeta * r) and cosh(zeta * r)
+ * of each node are computed once when the policy is built (in compact
+ * mode they are kept in float only, and computed again for the pairs
+ * evaluated in double precision) */
+class hg_hyperbolic_policy : public hg_policy {
+protected:
+  double zeta;
+  double radius;
+  vector<double> sinh_zr;
+  vector<double> cosh_zr;
+public:
+  hg_hyperbolic_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    zeta((*graph)[boost::graph_bundle].zeta_eta), radius(p.radius) {
+    int n = num_vertices(*graph);
+    int id;
+    sinh_zr.resize(n);
+    cosh_zr.resize(n);
+    for(id = 0; id < n; id++) {
+      sinh_zr[id] = sinh(zeta * (*graph)[id].r);
+      cosh_zr[id] = cosh(zeta * (*graph)[id].r);
+    }
+  }
+  inline double distance(const int i, const hg_coordinate_t & node1, 
+			 const int j, const hg_coordinate_t & node2) const {
+    if(node1.r == node2.r && node1.theta == node2.theta) {
+      return 0;
+    }
+    if(node1.theta == node2.theta) {
+      return abs(node1.r-node2.r);
+    }
+    double delta_theta = HG_PI - abs(HG_PI - abs(node1.theta - node2.theta));
+    double part1, part2;
+    if(cosh_zr.empty()) {
+      part1 = cosh(zeta * node1.r) * cosh(zeta * node2.r);
+      part2 = sinh(zeta * node1.r) * sinh(zeta * node2.r) * cos(delta_theta);
+    }
+    else {
+      part1 = cosh_zr[i] * cosh_zr[j];
+      part2 = sinh_zr[i] * sinh_zr[j] * cos(delta_theta);
+    }
+    hg_count(HG_COUNTER_ACOSH);
+    return  acosh(part1 - part2) / zeta;
+  }
+};
+
+
+class hg_hyperbolic_rgg_policy : public hg_hyperbolic_policy {
+private:
+  // compact mode: theta, cosh(zeta r), sinh(zeta r) and cosh(zeta R)
+  vector<float> theta_f;
+  vector<float> cosh_f;
+  vector<float> sinh_f;
+  float cosh_radius_f;
+public:
+  static const bool threshold = true;
+  hg_hyperbolic_rgg_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    hg_hyperbolic_policy(graph, p), cosh_radius_f(0) {}
+  /* the products of equation 13 must not overflow a float:
+   * nodes are within the disk (r <= R), hence cosh(zeta R)^2
+   * bounds them (R up to about 40). The float copies replace
+   * the double ones, the per-node arrays take 12 bytes per 
+   * node instead of 16 */
+  bool compact(const hg_graph_t * graph) {
+    double cosh_radius = cosh(zeta * radius);
+    if(!(cosh_radius * cosh_radius < 1e36)) {
+      return false;
+    }
+    int n = cosh_zr.size();
+    int id;
+    theta_f.resize(n);
+    cosh_f.resize(n);
+    sinh_f.resize(n);
+    for(id = 0; id < n; id++) {
+      if((*graph)[id].r > radius) {
+	vector<float>().swap(theta_f);
+	vector<float>().swap(cosh_f);
+	vector<float>().swap(sinh_f);
+	return false;
       }
+      theta_f[id] = (*graph)[id].theta;
+      cosh_f[id] = cosh_zr[id];
+      sinh_f[id] = sinh_zr[id];
     }
+    cosh_radius_f = cosh_radius;
+    vector<double>().swap(cosh_zr);
+    vector<double>().swap(sinh_zr);
+    return true;
   }
-  return graph;
-}
+  inline bool is_compact() const {
+    return !theta_f.empty();
+  }
+  /* d <= R  iff  cosh(zr1)cosh(zr2) - sinh(zr1)sinh(zr2)cos(dtheta) <= cosh(zR) */
+  inline int compact_link(const int i, const int j) const {
+    float delta_theta = (float) HG_PI - fabsf((float) HG_PI - fabsf(theta_f[i] - theta_f[j]));
+    float part1 = cosh_f[i] * cosh_f[j];
+    float part2 = sinh_f[i] * sinh_f[j];
+    float x = part1 - part2 * cosf(delta_theta);
+    float margin = (part1 + part2) * HG_COMPACT_TOLERANCE;
+    if(x < cosh_radius_f - margin) {
+      return 1;
+    }
+    if(x > cosh_radius_f + margin) {
+      return 0;
+    }
+    return -1;
+  }
+  /* d <= R  iff  cos(dtheta) >= (cosh(zr1)cosh(zr2) - cosh(zR)) / (sinh(zr1)sinh(zr2)), 
+   * the right side increases with r2 when r1 <= R, hence the angle
+   * computed for r bounds the one of every r2 >= r */
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    if(node.r > radius || node.r + r <= radius || node.r == 0 || r == 0) {
+      return HG_PI;
+    }
+    double cos_min = (cosh(zeta * node.r) * cosh(zeta * r) - cosh(zeta * radius)) /
+      (sinh(zeta * node.r) * sinh(zeta * r));
+    if(cos_min <= -1) {
+      return HG_PI;
+    }
+    if(cos_min > 1) {
+      cos_min = 1;
+    }
+    return acos(cos_min) + 1e-9; // margin for rounding errors
+  }
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    // equation 32: Heaviside function
+    if(distance(i, node1, j, node2) <= radius) {
+      return 1;
+    }
+    return 0;
+  }
+};
 
 
-inline double hg_connection_probability_hyperbolic_standard(const hg_graph_t * graph,
-							    const hg_algorithm_parameters_t & p,
-							    const hg_coordinate_t & node1, 
-							    const hg_coordinate_t & node2,
-							    r_precomputedsinhcosh * r_psc = NULL) {
-  // check if it is the same node
+class hg_hyperbolic_standard_policy : public hg_hyperbolic_policy {
+private:
+  double factor; // 1/t * zeta/2
+public:
+  static const bool threshold = false;
+  hg_hyperbolic_standard_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    hg_hyperbolic_policy(graph, p),
+    factor((double)1.0/(*graph)[boost::graph_bundle].temperature * zeta/2.0) {}
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    return HG_PI;
+  }
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    // check if it is the same node
+    if(node1.r == node2.r && node1.theta == node2.theta) {
+      return 0;
+    }
+    // equation 12: Fermi-Dirac function
+    double x = distance(i, node1, j, node2);
+    double exponent = factor * (x - radius);
+    hg_count(HG_COUNTER_EXP);
+    return 1.0 / (exp(exponent) + 1.0); 
+  }
+};
+
+
+class hg_scm_policy : public hg_policy {
+private:
+  double half_eta;
+  double radius;
+public:
+  static const bool threshold = false;
+  hg_scm_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    half_eta((double) p.eta/2.0), radius(p.radius) {}
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    return HG_PI;
+  }
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    // equation (39), zeta goes to infinity: x = r1 + r2
+    double x = 0;
+    if(!(node1.r == node2.r && node1.theta == node2.theta)) {
+      x = node1.r + node2.r;
+    }
+    double exponent = half_eta * (x - radius);
+    hg_count(HG_COUNTER_EXP);
+    return 1.0 / (exp(exponent) + 1.0); 
+  }
+};
+
+
+// angular distance, used by angular_rgg and soft_rgg
+inline double hg_angular_distance(const hg_coordinate_t & node1, 
+				  const hg_coordinate_t & node2) {
   if(node1.r == node2.r && node1.theta == node2.theta) {
     return 0;
   }
-  // equation 12: Fermi-Dirac function
-  double zeta = (*graph)[boost::graph_bundle].zeta_eta;
-  double t =  (*graph)[boost::graph_bundle].temperature;
-  double x = hg_hyperbolic_distance_hyperbolic_rgg_standard(graph, node1, node2, r_psc);
-  double exponent = (double)1.0/t * zeta/2.0  * (x - p.radius);
-  return 1.0 / (exp(exponent) + 1.0); 
+  return HG_PI - abs(HG_PI - abs(node1.theta - node2.theta));
 }
 
 
-hg_graph_t * hg_hyperbolic_standard(const int n, const double k_bar, 
-				    const double exp_gamma,
-				    const double temperature,			 			       
-				    const double zeta, const int seed, 
-				    bool verbose) {
-  if(verbose) {
-    cout << "-> Hyperbolic Standard Graph" << endl << endl;
+class hg_angular_rgg_policy : public hg_policy {
+private:
+  double max_distance; // pi * k / n
+  // compact mode: theta
+  vector<float> theta_f;
+  float max_distance_f;
+public:
+  static const bool threshold = true;
+  hg_angular_rgg_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    max_distance(HG_PI * (*graph)[boost::graph_bundle].expected_degree / 
+		 (double) (*graph)[boost::graph_bundle].expected_n), max_distance_f(0) {}
+  bool compact(const hg_graph_t * graph) {
+    int n = num_vertices(*graph);
+    int id;
+    theta_f.resize(n);
+    for(id = 0; id < n; id++) {
+      theta_f[id] = (*graph)[id].theta;
+    }
+    max_distance_f = max_distance;
+    return true;
   }
-  hg_graph_t * graph = new hg_graph_t(n);
-  if(graph == NULL) {
-    hg_log_warn("Unable to allocate memory for graph object");
-    return NULL;
+  inline bool is_compact() const {
+    return !theta_f.empty();
   }
-  // init graph
-  hg_init_graph(graph, n, k_bar, exp_gamma, temperature,
-		zeta, seed, HYPERBOLIC_STANDARD);
-  // computing internal parameters
-  hg_debug("\tInternal parameters computation");
-  hg_algorithm_parameters_t p;
-  // alpha calculation. different for cold and hot regimes
-  if(temperature <= 1) {
-    p.alpha = 0.5 * zeta * (exp_gamma-1.0);
+  // angular distances are up to pi, the tolerance is absolute
+  inline int compact_link(const int i, const int j) const {
+    float x = (float) HG_PI - fabsf((float) HG_PI - fabsf(theta_f[i] - theta_f[j]));
+    if(x < max_distance_f - HG_COMPACT_TOLERANCE) {
+      return 1;
+    }
+    if(x > max_distance_f + HG_COMPACT_TOLERANCE) {
+      return 0;
+    }
+    return -1;
   }
-  else {
-    p.alpha = 0.5 * zeta/temperature * (exp_gamma-1.0);
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    return max_distance + 1e-9; // margin for rounding errors
   }
-  p.eta = -1; // not relevant for current model
-  p.c = -1;  // not relevant for current model
-  p.radius = hg_get_R_from_numerical_integration(graph, p);
-  hg_debug("\tInternal parameters:");
-  hg_debug("\t\tAlpha: %f", p.alpha);
-  hg_debug("\t\tRadius: %f", p.radius);
-  r_precomputedsinhcosh r_psc; 
-  hg_assign_coordinates(graph, p, &r_psc);
-  hg_coordinate_t c1, c2;
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    // equation 55: Heaviside function
+    if(hg_angular_distance(node1, node2) <= max_distance) {
+      return 1;
+    }
+    return 0;
+  }
+};
+
+
+class hg_soft_rgg_policy : public hg_policy {
+private:
+  double c;
+  double beta;
+public:
+  static const bool threshold = false;
+  hg_soft_rgg_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    c(p.c), beta(1.0 / (*graph)[boost::graph_bundle].temperature) {}
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    return HG_PI;
+  }
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    double x = hg_angular_distance(node1, node2);
+    // equation 46
+    return 1.0 / (1.0 + c * pow((x / HG_PI), beta) );
+  }
+};
+
+
+class hg_erdos_renyi_policy : public hg_policy {
+private:
+  double p_link;
+public:
+  static const bool threshold = false;
+  hg_erdos_renyi_policy(const hg_graph_t * graph, const hg_algorithm_parameters_t & p) :
+    p_link(1.0 / (1.0 + (double)((double)(*graph)[boost::graph_bundle].expected_n/
+				 (*graph)[boost::graph_bundle].expected_degree))) {}
+  inline double max_angle(const hg_coordinate_t & node, const double r) const {
+    return HG_PI;
+  }
+  inline double probability(const int i, const hg_coordinate_t & node1, 
+			    const int j, const hg_coordinate_t & node2) const {
+    // connection probability is given
+    // by equation 61
+    return p_link;
+  }
+};
+
+
+/* ================= generator driver  ================= */
+
+
+/* sharded generation (see hg_set_shard): the shard owns the nodes
+ * whose angular coordinate lies in the sector [2 pi shard / N, 
+ * 2 pi (shard + 1) / N), and it creates the links whose lower id
+ * endpoint is one of them */
+static int hg_shard = 0;
+static int hg_num_shards = 1;
+
+
+void hg_set_shard(const int shard, const int num_shards) {
+  if(num_shards < 1 || shard < 0 || shard >= num_shards) {
+    hg_log_warn("Wrong shard %d/%d, generating the whole graph", shard, num_shards);
+    hg_shard = 0;
+    hg_num_shards = 1;
+    return;
+  }
+  hg_shard = shard;
+  hg_num_shards = num_shards;
+}
+
+
+/* compact mode (see hg_set_compact) */
+static bool hg_compact = false;
+
+
+void hg_set_compact(const bool compact) {
+  hg_compact = compact;
+}
+
+
+/* decision on the pair (i, j) given its random number u: in compact
+ * mode threshold models decide on the float copies of the coordinates
+ * and only the pairs they cannot decide are evaluated in double 
+ * precision. The probability being 0 or 1, the decision does not
+ * depend on u (u < 1), yet u is extracted as in the default mode */
+template <class Model>
+static inline bool hg_linked(const Model & model, const double u,
+			     const int i, const hg_coordinate_t & c1,
+			     const int j, const hg_coordinate_t & c2) {
+  if(Model::threshold && model.is_compact()) {
+    int link = model.compact_link(i, j);
+    if(link >= 0) {
+      return link == 1;
+    }
+    hg_count(HG_COUNTER_RECHECKS);
+  }
+  return u < model.probability(i, c1, j, c2);
+}
+
+
+/* float copies of the coordinates of the model in compact mode */
+template <class Model>
+static void hg_compact_model(Model & model, const hg_graph_t * graph) {
+  if(!hg_compact) {
+    return;
+  }
+  bool on = model.compact(graph);
+  if(!on && Model::threshold) {
+    hg_log_warn("The radius is too large for the compact mode, using double precision");
+  }
+  else if(!on) {
+    hg_debug("\tThe compact mode is available for threshold models only");
+  }
+  HG_Profile::set("compact", on);
+}
+
+
+static inline int hg_sector(const double theta, const int num_sectors) {
+  int sector = (int) floor(theta / (2 * HG_PI) * num_sectors);
+  return max(0, min(num_sectors - 1, sector));
+}
+
+
+/* every pair (id, other_id), id < other_id, is linked with the
+ * probability provided by the model: pairs are visited in the
+ * same order and a random number is extracted for each one.
+ * Links are appended to the edges buffer, that is therefore 
+ * sorted by (id, other_id) and has no duplicates. If a pipeline
+ * is provided the buffer is handed to it each time it holds a
+ * block of links (the rest is left in the buffer). With a 
+ * checkpoint the first rows_done rows (whose links are in the
+ * buffer already) are skipped, and the progress is saved
+ * periodically */
+template <class Model>
+static void hg_create_links_by_pair(const hg_coordinate_array_t & coordinates, 
+				    const vector<int> & rows, const Model & model,
+				    const double k_bar, hg_link_buffer_t & edges,
+				    hg_link_pipeline_t * pipeline,
+				    hg_checkpoint_t * checkpoint, const long rows_done);
+
+template <class Model>
+static void hg_create_links(const hg_graph_t * graph, const Model & model,
+			    hg_link_buffer_t & edges,
+			    hg_link_pipeline_t * pipeline,
+			    hg_checkpoint_t * checkpoint, const long rows_done) {
+  int n = (*graph)[boost::graph_bundle].expected_n;
+  hg_coordinate_array_t coordinates(n);
   int id, other_id;
+  for(id = 0; id < n; id++) {
+    coordinates[id] = hg_get_coordinate(graph, id);
+  }
+  // shards require pair random numbers
+  if(HG_Random::is_pair_mode() || hg_num_shards > 1) {
+    vector<int> rows;
+    for(id = 0; id < n; id++) {
+      if(hg_num_shards == 1 || hg_sector(coordinates[id].theta, hg_num_shards) == hg_shard) {
+	rows.push_back(id);
+      }
+    }
+    hg_create_links_by_pair(coordinates, rows, model, (*graph)[boost::graph_bundle].expected_degree,
+			    edges, pipeline, checkpoint, rows_done);
+    return;
+  }
   hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);
-      if(HG_Random::get_random_01_value() < hg_connection_probability_hyperbolic_standard(graph, p, c1, c2, &r_psc)) {
-	add_edge(id, other_id, *graph);
+  for(id = rows_done; id < n; id++) {
+    const hg_coordinate_t & c1 = coordinates[id];
+    for(other_id = id+1; other_id < n; other_id++) {
+      hg_count(HG_COUNTER_PAIRS);
+      if(hg_linked(model, HG_Random::get_random_01_value(), id, c1, other_id, coordinates[other_id])) {
+	edges.push_back(make_pair(id, other_id));
+	hg_count(HG_COUNTER_EDGES);
 	//hg_debug("\t\tNew link: %d - %d ", id, other_id);
       }
     }
+    if(pipeline != NULL && edges.size() >= HG_PIPELINE_BLOCK_SIZE) {
+      hg_pipeline_push(pipeline, edges);
+    }
+    if(checkpoint != NULL && hg_checkpoint_due(checkpoint)) {
+      hg_checkpoint_write(checkpoint, id + 1, edges);
+    }
   }
-  return graph;
 }
 
 
-static double hg_hyperbolic_distance_scm(const hg_graph_t * graph,
-					 const hg_coordinate_t & node1, 
-					 const hg_coordinate_t & node2) {
-  // check if it is the same node
-  if(node1.r == node2.r && node1.theta == node2.theta) {
-    return 0;
+/* estimated cost of the rows of the pair loop (see hg_scheduler.h):
+ * the n - id - 1 pairs of row id are evaluated and a link is accepted
+ * with probability about kappa / (n - 1), the expected degree kappa
+ * of a node decreases as e^(-r/2) with its radial coordinate (hubs
+ * are close to the origin) and its average is k_bar. A link costs 
+ * HG_LINK_COST pair evaluations */
+#define HG_LINK_COST 4.0
+
+static void hg_pair_costs(const hg_coordinate_array_t & coordinates, const double k_bar,
+			  const vector<int> & rows, const long rows_done, 
+			  vector<double> & costs) {
+  int n = coordinates.size();
+  int id;
+  long row;
+  double weight = 0;
+  for(id = 0; id < n; id++) {
+    weight += exp(-coordinates[id].r / 2);
+  }
+  costs.resize(rows.size() - rows_done);
+  for(row = rows_done; row < (long) rows.size(); row++) {
+    id = rows[row];
+    double acceptance = (weight > 0 && n > 1) ? 
+      k_bar * n * exp(-coordinates[id].r / 2) / weight / (n - 1) : 0;
+    costs[row - rows_done] = (n - id - 1) * (1 + HG_LINK_COST * min(1.0, acceptance));
   }
-  // curvature is infinite, so 1/zeta goes to zero  
-  return node1.r + node2.r;
 }
 
 
-static double hg_connection_probability_scm(const hg_graph_t * graph,
-					    const hg_algorithm_parameters_t & p,
-					    const hg_coordinate_t & node1, 
-					    const hg_coordinate_t & node2) {
-  // equation (39)
-  double x = hg_hyperbolic_distance_scm(graph, node1, node2);
-  double exponent = (double) p.eta/2.0  * (x - p.radius);
-  return 1.0 / (exp(exponent) + 1.0); 
+/* counter-based random numbers (see HG_Random): the decision on a
+ * pair does not depend on the other pairs, hence tasks (contiguous
+ * rows having about the same estimated cost) are processed in 
+ * parallel and then concatenated in order, so that the buffer is 
+ * the same whatever the number of threads. Only the rows (sorted
+ * ids) provided are visited. With a pipeline or a checkpoint the 
+ * tasks are scheduled in order and appended as soon as all the 
+ * previous ones are done */
+template <class Model>
+static void hg_create_links_by_pair(const hg_coordinate_array_t & coordinates, 
+				    const vector<int> & rows, const Model & model,
+				    const double k_bar, hg_link_buffer_t & edges,
+				    hg_link_pipeline_t * pipeline,
+				    hg_checkpoint_t * checkpoint, const long rows_done) {
+  const int block_size = 256;
+  int n = coordinates.size();
+  long num_rows = rows.size();
+  bool ordered = (pipeline != NULL || checkpoint != NULL);
+  vector<double> costs;
+  hg_pair_costs(coordinates, k_bar, rows, rows_done, costs);
+  hg_scheduler_t * scheduler = hg_scheduler_new(costs, (num_rows - rows_done + block_size - 1) / block_size, 
+						ordered);
+  long num_tasks = hg_scheduler_tasks(scheduler);
+  vector<vector<pair<int, int> > > task_edges(num_tasks);
+  vector<long> task_end(num_tasks, -1);
+  long t, next_task = 0;
+  hg_debug("\tCreating links (pair random numbers)");
+#pragma omp parallel
+  {
+    long task, first, last, row;
+    int id, other_id;
+    while(hg_scheduler_next(scheduler, task, first, last)) {
+      for(row = first + rows_done; row < last + rows_done; row++) {
+	id = rows[row];
+	const hg_coordinate_t & c1 = coordinates[id];
+	for(other_id = id+1; other_id < n; other_id++) {
+	  hg_count(HG_COUNTER_PAIRS);
+	  if(hg_linked(model, HG_Random::get_pair_random_01_value(id, other_id),
+		       id, c1, other_id, coordinates[other_id])) {
+	    task_edges[task].push_back(make_pair(id, other_id));
+	    hg_count(HG_COUNTER_EDGES);
+	  }
+	}
+      }
+      if(ordered) {
+#pragma omp critical(hg_pipeline)
+	{
+	  task_end[task] = last + rows_done;
+	  for(; next_task < num_tasks && task_end[next_task] >= 0; next_task++) {
+	    edges.insert(edges.end(), task_edges[next_task].begin(), task_edges[next_task].end());
+	    vector<pair<int, int> >().swap(task_edges[next_task]);
+	    if(pipeline != NULL && edges.size() >= HG_PIPELINE_BLOCK_SIZE) {
+	      hg_pipeline_push(pipeline, edges);
+	    }
+	  }
+	  if(checkpoint != NULL && next_task > 0 && hg_checkpoint_due(checkpoint)) {
+	    hg_checkpoint_write(checkpoint, task_end[next_task - 1], edges);
+	  }
+	}
+      }
+    }
+  }
+  hg_scheduler_free(scheduler, "links");
+  for(t = next_task; t < num_tasks; t++) {
+    edges.insert(edges.end(), task_edges[t].begin(), task_edges[t].end());
+    vector<pair<int, int> >().swap(task_edges[t]);
+  }
 }
 
 
-hg_graph_t * hg_soft_configuration_model(const int n, const double k_bar, 
-					 const double exp_gamma,
-					 const double eta, const int seed, 
-					 bool verbose) {
-  if(verbose) {
-    cout << "-> Soft Configuration Model Graph" << endl << endl;
+/* random number of the pair (id, other_id), id < other_id, taken 
+ * from the stream or computed from the pair (see HG_Random) */
+inline double hg_pair_random_01_value(const int id, const int other_id) {
+  if(HG_Random::is_pair_mode()) {
+    return HG_Random::get_pair_random_01_value(id, other_id);
   }
-  hg_graph_t * graph = new hg_graph_t(n);
+  return HG_Random::get_random_01_value();
+}
+
+
+/* expected number of links (n k / 2, divided by the number of 
+ * shards) plus a margin of a few standard deviations, so that 
+ * the buffer is not reallocated */
+static size_t hg_expected_edges(const hg_graph_t * graph) {
+  double m = (*graph)[boost::graph_bundle].expected_n 
+    * (*graph)[boost::graph_bundle].expected_degree / 2.0 / hg_num_shards;
+  return (size_t) (m + 4.0 * sqrt(m) + 16);
+}
+
+
+/* the adjacency is built from the whole buffer (see hg_add_edges),
+ * edges(g) lists the links in the order they have been generated */
+static void hg_build_adjacency(hg_graph_t * graph, const hg_link_buffer_t & edges) {
+  hg_debug("\tBuilding adjacency (%lu links)", edges.size());
+  hg_add_edges(graph, edges);
+}
+
+
+/* pipelined generation (see hg_graph_generator_to_file): links are
+ * written in hg_output_file while they are created, they are not
+ * added to the graph */
+static string hg_output_file = "";
+static long hg_output_links = -1;
+
+
+/* checkpoints of the link creation (see hg_set_checkpoint) */
+static string hg_checkpoint_file = "";
+static double hg_checkpoint_interval = 0;
+static bool hg_checkpoint_resume = false;
+
+
+void hg_set_checkpoint(const string filename, const double interval, const bool resume) {
+  hg_checkpoint_file = filename;
+  hg_checkpoint_interval = interval;
+  hg_checkpoint_resume = resume;
+}
+
+
+/* common part of all the generators, called once the internal
+ * parameters have been computed: coordinates, then links */
+template <class Model>
+static hg_graph_t * hg_generate(hg_graph_t * graph, const hg_algorithm_parameters_t & p) {
+  HG_Profile::end();
+  HG_Profile::begin("coordinates");
+  hg_assign_coordinates(graph, p);
+  Model model(graph, p);
+  hg_compact_model(model, graph);
+  HG_Profile::end();
+  HG_Profile::begin("links");
+  hg_link_buffer_t edges;
+  hg_link_pipeline_t * pipeline = NULL;
+  hg_checkpoint_t * checkpoint = NULL;
+  long rows_done = 0;
+  if(!hg_checkpoint_file.empty() && hg_output_file.empty()) {
+    edges.reserve(hg_expected_edges(graph));
+    checkpoint = hg_checkpoint_open(hg_checkpoint_file, hg_checkpoint_interval, graph, 
+				    hg_shard, hg_num_shards, hg_checkpoint_resume, rows_done, edges);
+    if(checkpoint == NULL) {
+      HG_Profile::end();
+      delete graph;
+      return NULL;
+    }
+    HG_Profile::set("checkpoint_interval", hg_checkpoint_interval);
+  }
+  else if(!hg_output_file.empty()) {
+    pipeline = hg_pipeline_start(graph, hg_output_file);
+    if(pipeline == NULL) {
+      HG_Profile::end();
+      return graph;
+    }
+    edges.reserve(HG_PIPELINE_BLOCK_SIZE);
+  }
+  else {
+    edges.reserve(hg_expected_edges(graph));
+  }
+  hg_create_links(graph, model, edges, pipeline, checkpoint, rows_done);
+  // the generation is complete
+  hg_checkpoint_close(checkpoint, true);
+  HG_Profile::end();
+  if(pipeline != NULL) {
+    // waiting for the I/O thread
+    HG_Profile::begin("output");
+    hg_pipeline_push(pipeline, edges);
+    hg_output_links = hg_pipeline_finish(pipeline);
+    HG_Profile::end();
+    HG_Profile::set("edges", hg_output_links);
+  }
+  else {
+    HG_Profile::begin("adjacency");
+    hg_build_adjacency(graph, edges);
+    HG_Profile::end();
+    HG_Profile::set("edges", num_edges(*graph));
+  }
+  HG_Profile::set("pair_random_numbers", HG_Random::is_pair_mode() || hg_num_shards > 1);
+  hg_allocation_profile();
+  if(hg_num_shards > 1) {
+    HG_Profile::set("shard", hg_shard);
+    HG_Profile::set("num_shards", hg_num_shards);
+  }
+  return graph;
+}
+
+
+/* ================= single model graph generators  ================= */
+
+
+/* allocate the graph, initialize its parameters and compute
+ * the internal ones */
+static hg_graph_t * hg_new_graph(const int & n, const double & k_bar, 
+				 const double & exp_gamma, const double & t, 
+				 const double & zeta_eta, const int & seed, 
+				 const hg_graph_type & gt, hg_algorithm_parameters_t & p) {
+  HG_Profile::begin("parameters");
+  hg_graph_t * graph = hg_create_graph(n);
   if(graph == NULL) {
     hg_log_warn("Unable to allocate memory for graph object");
     return NULL;
   }
   // init graph
-  hg_init_graph(graph, n, k_bar, exp_gamma, HG_INF_TEMPERATURE /* t = inf */,
-		eta, seed, SOFT_CONFIGURATION_MODEL);
+  hg_init_graph(graph, n, k_bar, exp_gamma, t, zeta_eta, seed, gt);
   // computing internal parameters
-  hg_debug("\tInternal parameters computation");
-  // zeta goes to infinity
-  //(*graph)[boost::graph_bundle].zeta_eta = numeric_limits<double>::max( );
+  hg_get_internal_parameters(graph, p);
+  return graph;
+}
+
+
+hg_graph_t * hg_hyperbolic_rgg(const int n, const double k_bar, 
+			       const double exp_gamma,
+			       const double zeta, const int seed, 
+			       bool verbose) {
+  if(verbose) {
+    cout << "-> Hyperbolic Random Geometric Graph" << endl << endl;
+  }
   hg_algorithm_parameters_t p;
-  p.eta = (*graph)[boost::graph_bundle].zeta_eta;
-  p.alpha = 0.5 * p.eta * (exp_gamma-1.0);
-  p.c = -1;  // not relevant for current model
-  p.radius = hg_get_R_from_numerical_integration(graph, p);
-  hg_debug("\t\talpha: %f", p.alpha);
-  hg_debug("\t\teta: %f", p.eta);
-  hg_debug("\t\tradius: %f", p.radius);
-  hg_assign_coordinates(graph, p);
-  hg_coordinate_t c1, c2;
-  int id, other_id;
-  hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);
-      if(HG_Random::get_random_01_value() < hg_connection_probability_scm(graph, p, c1, c2)) {
-	add_edge(id, other_id, *graph);
-	//hg_debug("\t\tNew link: %d - %d ", id, other_id);
-      }
-    }
+  hg_graph_t * graph = hg_new_graph(n, k_bar, exp_gamma, 0 /* t = 0 */,
+				    zeta, seed, HYPERBOLIC_RGG, p);
+  if(graph == NULL) {
+    return NULL;
   }
-  return graph;
+  return hg_generate<hg_hyperbolic_rgg_policy>(graph, p);
 }
 
 
-static double hg_hyperbolic_distance_angular_soft_rgg(const hg_graph_t * graph,
-						      const hg_coordinate_t & node1, 
-						      const hg_coordinate_t & node2) {
-  // check if it is the same node
-  if(node1.r == node2.r && node1.theta == node2.theta) {
-    return 0;
+hg_graph_t * hg_hyperbolic_standard(const int n, const double k_bar, 
+				    const double exp_gamma,
+				    const double temperature,			 			       
+				    const double zeta, const int seed, 
+				    bool verbose) {
+  if(verbose) {
+    cout << "-> Hyperbolic Standard Graph" << endl << endl;
   }
-  // delta theta
-  return HG_PI - abs(HG_PI - abs(node1.theta - node2.theta));
+  hg_algorithm_parameters_t p;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, exp_gamma, temperature,
+				    zeta, seed, HYPERBOLIC_STANDARD, p);
+  if(graph == NULL) {
+    return NULL;
+  }
+  return hg_generate<hg_hyperbolic_standard_policy>(graph, p);
 }
 
 
-static double hg_connection_probability_angular_rgg(const hg_graph_t * graph,
-						    const hg_coordinate_t & node1, 
-						    const hg_coordinate_t & node2) {
-  // equation 55: Heaviside function
-  if(hg_hyperbolic_distance_angular_soft_rgg(graph, node1, node2) <=
-     HG_PI * (*graph)[boost::graph_bundle].expected_degree / (double) (*graph)[boost::graph_bundle].expected_n) {
-    return 1;
+hg_graph_t * hg_soft_configuration_model(const int n, const double k_bar, 
+					 const double exp_gamma,
+					 const double eta, const int seed, 
+					 bool verbose) {
+  if(verbose) {
+    cout << "-> Soft Configuration Model Graph" << endl << endl;
+  }
+  hg_algorithm_parameters_t p;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, exp_gamma, HG_INF_TEMPERATURE /* t = inf */,
+				    eta, seed, SOFT_CONFIGURATION_MODEL, p);
+  if(graph == NULL) {
+    return NULL;
   }
-  return 0;
+  return hg_generate<hg_scm_policy>(graph, p);
 }
 
 
@@ -369,52 +983,16 @@ hg_graph_t * hg_angular_rgg(const int n, const double k_bar,
   if(verbose) {
     cout << "-> Angular Random Geometric Graph" << endl << endl;
   }
-  hg_graph_t * graph = new hg_graph_t(n);
+  hg_algorithm_parameters_t p;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, 0 /* t = 0 */,
+				    zeta, seed, ANGULAR_RGG, p);
   if(graph == NULL) {
-    hg_log_warn("Unable to allocate memory for graph object");
     return NULL;
   }
-  // init graph
-  hg_init_graph(graph, n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, 0 /* t = 0 */,
-		zeta, seed, ANGULAR_RGG);
-  // computing internal parameters
-  hg_debug("\tInternal parameters computation");
-  hg_algorithm_parameters_t p;
-  p.radius = HG_INF_RADIUS; 
-  p.alpha = -1; // not relevant for current model
-  p.eta = -1; // not relevant for current model
-  p.c = -1;  // not relevant for current model
-  hg_assign_coordinates(graph, p);
-  hg_coordinate_t c1, c2;
-  int id, other_id;
-  hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);
-      if(HG_Random::get_random_01_value() < hg_connection_probability_angular_rgg(graph, c1, c2)) {
-	add_edge(id, other_id, *graph);
-	hg_debug("\t\tNew link: %d - %d ", id, other_id);
-      }
-    }
-  }
-  return graph;
+  return hg_generate<hg_angular_rgg_policy>(graph, p);
 }
 
 
-
-static double hg_connection_probability_soft_rgg(const hg_graph_t * graph,
-						 const hg_algorithm_parameters_t & p,
-						 const hg_coordinate_t & node1, 
-						 const hg_coordinate_t & node2) {
-  double x = hg_hyperbolic_distance_angular_soft_rgg(graph, node1, node2);
-  // equation 46
-  double beta = 1.0 / (*graph)[boost::graph_bundle].temperature;  
-  return 1.0 / (1.0 + p.c * pow((x / HG_PI), beta) );
-}
-
-
-
 hg_graph_t * hg_soft_rgg(const int n, const double k_bar, 
 			 const double temperature,			 
 			 const double zeta, const int seed, 
@@ -422,95 +1000,370 @@ hg_graph_t * hg_soft_rgg(const int n, const double k_bar,
   if(verbose) {
     cout << "-> Soft Random Geometric Graph" << endl << endl;
   }
-  hg_graph_t * graph = new hg_graph_t(n);
+  hg_algorithm_parameters_t p;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, temperature,
+				    zeta, seed, SOFT_RGG, p);
   if(graph == NULL) {
-    hg_log_warn("Unable to allocate memory for graph object");
     return NULL;
   }
-  // init graph
-  hg_init_graph(graph, n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, temperature /* t = 0 */,
-		zeta, seed, SOFT_RGG);
-  // computing internal parameters
-  hg_debug("\tInternal parameters computation");
+  return hg_generate<hg_soft_rgg_policy>(graph, p);
+}
+
+
+hg_graph_t * hg_erdos_renyi(const int n, const double k_bar, 			     
+			    const double zeta, const int seed, 
+			    bool verbose) {
+  if(verbose) {
+    cout << "-> Erdos-Renyi Graph" << endl << endl;
+  }
   hg_algorithm_parameters_t p;
-  p.radius = HG_INF_RADIUS; 
-  p.alpha = -1; // not relevant for current model
-  p.eta = -1; // not relevant for current model
-  p.c = hg_get_lambda_from_Gauss_hypergeometric_function(graph,p); 
-  hg_assign_coordinates(graph, p);
-  hg_coordinate_t c1, c2;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, 
+				    HG_INF_TEMPERATURE /* t = inf */,
+				    zeta, seed, ERDOS_RENYI, p);
+  if(graph == NULL) {
+    return NULL;
+  }
+  return hg_generate<hg_erdos_renyi_policy>(graph, p);
+}
+
+
+long hg_graph_generator_to_file(const int n, const double k_bar, const double exp_gamma,
+				const double t, const double zeta, const int seed,
+				const string filename, bool verbose) {
+  hg_output_file = filename;
+  hg_output_links = -1;
+  hg_graph_t * graph = hg_graph_generator(n, k_bar, exp_gamma, t, zeta, seed, verbose);
+  hg_output_file = "";
+  if(graph == NULL) {
+    return -1;
+  }
+  delete graph;
+  return hg_output_links;
+}
+
+
+/* ================= graph growth  ================= */
+
+
+/* Existing nodes grouped in bands of radial coordinate, each band
+ * sorted by angular coordinate: the candidates of a threshold model
+ * in a band lie in the angular window returned by max_angle for
+ * the smallest radius of the band. */
+class hg_band_index {
+private:
+  typedef pair<double, int> angle_id_t;
+  vector<double> min_r;
+  vector<vector<angle_id_t> > bands;
+  static void add_range(const vector<angle_id_t> & band, const double from, const double to,
+			vector<int> & candidates) {
+    vector<angle_id_t>::const_iterator it, end;
+    it = lower_bound(band.begin(), band.end(), make_pair(from, -1));
+    end = upper_bound(band.begin(), band.end(), make_pair(to, numeric_limits<int>::max()));
+    for(; it < end; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+public:
+  hg_band_index(const hg_graph_t * graph, const int n) {
+    if(n == 0) {
+      return;
+    }
+    vector<pair<double, int> > by_radius(n);
+    int id;
+    for(id = 0; id < n; id++) {
+      by_radius[id] = make_pair((*graph)[id].r, id);
+    }
+    sort(by_radius.begin(), by_radius.end());
+    int num_bands = max(1, (int) ceil(log((double) n + 1) / log(2.0)));
+    int band_size = (n + num_bands - 1) / num_bands;
+    for(id = 0; id < n; id++) {
+      if(id % band_size == 0) {
+	min_r.push_back(by_radius[id].first);
+	bands.push_back(vector<angle_id_t>());
+      }
+      int node = by_radius[id].second;
+      bands.back().push_back(make_pair((*graph)[node].theta, node));
+    }
+    for(id = 0; id < (int) bands.size(); id++) {
+      sort(bands[id].begin(), bands[id].end());
+    }
+  }
+  /* ids of the nodes that can be linked to node, sorted */
+  template <class Model>
+  void candidates(const Model & model, const hg_coordinate_t & node, vector<int> & result) const {
+    result.clear();
+    unsigned int b;
+    for(b = 0; b < bands.size(); b++) {
+      double max_angle = model.max_angle(node, min_r[b]);
+      if(max_angle >= HG_PI) {
+	add_range(bands[b], -1, 3 * HG_PI, result);
+	continue;
+      }
+      double from = node.theta - max_angle;
+      double to = node.theta + max_angle;
+      add_range(bands[b], max(from, 0.0), min(to, 2 * HG_PI), result);
+      // the window crosses 0 (or 2 pi)
+      if(from < 0) {
+	add_range(bands[b], from + 2 * HG_PI, 2 * HG_PI, result);
+      }
+      if(to > 2 * HG_PI) {
+	add_range(bands[b], 0, to - 2 * HG_PI, result);
+      }
+    }
+    sort(result.begin(), result.end());
+    result.erase(unique(result.begin(), result.end()), result.end());
+  }
+};
+
+
+/* links of the nodes in [n0, n): pairs are visited by new node
+ * (other_id) and then by id < other_id, the links with the old 
+ * nodes of threshold models are searched through the index */
+template <class Model>
+static void hg_create_new_links(const hg_graph_t * graph, const Model & model, const int n0,
+				hg_link_buffer_t & edges) {
+  int n = num_vertices(*graph);
+  hg_coordinate_array_t coordinates(n);
   int id, other_id;
+  for(id = 0; id < n; id++) {
+    coordinates[id] = hg_get_coordinate(graph, id);
+  }
+  hg_band_index * index = NULL;
+  if(Model::threshold) {
+    index = new hg_band_index(graph, n0);
+  }
+  vector<int> candidates;
   hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);
-      if(HG_Random::get_random_01_value() < hg_connection_probability_soft_rgg(graph, p, c1, c2)) {
-	add_edge(id, other_id, *graph);
-	hg_debug("\t\tNew link: %d - %d ", id, other_id);
+  for(other_id = n0; other_id < n; other_id++) {
+    const hg_coordinate_t & c2 = coordinates[other_id];
+    int first_id = 0;
+    if(index != NULL) {
+      // old nodes: only the candidates, there is no need to
+      // extract a random number as the probability is 0 or 1
+      index->candidates(model, c2, candidates);
+      unsigned int i;
+      for(i = 0; i < candidates.size(); i++) {
+	hg_count(HG_COUNTER_PAIRS);
+	if(hg_linked(model, 0, candidates[i], coordinates[candidates[i]], other_id, c2)) {
+	  edges.push_back(make_pair(candidates[i], other_id));
+	  hg_count(HG_COUNTER_EDGES);
+	}
+      }
+      first_id = n0;
+    }
+    for(id = first_id; id < other_id; id++) {
+      hg_count(HG_COUNTER_PAIRS);
+      if(hg_linked(model, hg_pair_random_01_value(id, other_id), id, coordinates[id], other_id, c2)) {
+	edges.push_back(make_pair(id, other_id));
+	hg_count(HG_COUNTER_EDGES);
       }
     }
   }
+  delete index;
+}
+
+
+template <class Model>
+static hg_graph_t * hg_grow(hg_graph_t * graph, const int delta, const int seed) {
+  int n0 = num_vertices(*graph);
+  int id;
+  // internal parameters of the original graph
+  HG_Profile::begin("parameters");
+  hg_algorithm_parameters_t p;
+  hg_get_internal_parameters(graph, p);
+  HG_Profile::end();
+  HG_Profile::begin("coordinates");
+  HG_Random::init(seed);
+  {
+    // the out-edge sets of the new nodes go in the arena of the graph
+    hg_arena_scope scope(hg_graph_arena(graph));
+    for(id = 0; id < delta; id++) {
+      add_vertex(*graph);
+    }
+  }
+  hg_assign_coordinates(graph, p, n0);
+  Model model(graph, p);
+  hg_compact_model(model, graph);
+  HG_Profile::end();
+  HG_Profile::begin("links");
+  hg_link_buffer_t edges;
+  hg_create_new_links(graph, model, n0, edges);
+  HG_Profile::end();
+  HG_Profile::begin("adjacency");
+  hg_build_adjacency(graph, edges);
+  HG_Profile::end();
+  HG_Profile::set("new_edges", edges.size());
+  hg_allocation_profile();
+  (*graph)[boost::graph_bundle].expected_n = n0 + delta;
   return graph;
 }
 
 
-static double hg_hyperbolic_distance_er(const hg_graph_t * graph,
-					const hg_coordinate_t & node1, 
-					const hg_coordinate_t & node2) {
-  // check if it is the same node
-  if(node1.r == node2.r && node1.theta == node2.theta) {
-    return 0;
+hg_graph_t * hg_graph_grow(hg_graph_t * graph, const int delta, 
+			   const int seed, bool verbose) {
+  if(graph == NULL) {
+    hg_log_err("Null graph provided.");
+    return NULL;
   }
-  // there is no "real distance", indeed!
-  return 1; 
+  if(verbose) {
+    cout << "-> Adding " << delta << " nodes to a graph of " 
+	 << num_vertices(*graph) << " nodes" << endl << endl;
+  }
+  switch((*graph)[boost::graph_bundle].type){
+  case HYPERBOLIC_RGG: 
+    return hg_grow<hg_hyperbolic_rgg_policy>(graph, delta, seed);
+  case HYPERBOLIC_STANDARD:
+    return hg_grow<hg_hyperbolic_standard_policy>(graph, delta, seed);
+  case SOFT_CONFIGURATION_MODEL:
+    return hg_grow<hg_scm_policy>(graph, delta, seed);
+  case ANGULAR_RGG:
+    return hg_grow<hg_angular_rgg_policy>(graph, delta, seed);
+  case SOFT_RGG:
+    return hg_grow<hg_soft_rgg_policy>(graph, delta, seed);
+  case ERDOS_RENYI:
+    return hg_grow<hg_erdos_renyi_policy>(graph, delta, seed);
+  default:
+    hg_log_err("Case not implemented yet");
+  }
+  return NULL;
 }
 
-static double hg_connection_probability_er(const hg_graph_t * graph,
-					   const hg_coordinate_t & node1, 
-					   const hg_coordinate_t & node2) {
-  // connection probability is given
-  // by equation 61
-  return 1.0 / (1.0 + (double)((double)(*graph)[boost::graph_bundle].expected_n/(*graph)[boost::graph_bundle].expected_degree)); 
+
+/* ================= implicit graphs  ================= */
+
+
+/* The links of threshold models are a function of the coordinates:
+ * the implicit graph stores the coordinates (a graph with no links)
+ * and a quadtree, the neighbours of a node are the nodes found by
+ * a range query that the model links to it */
+struct struct_hg_implicit_graph {
+  hg_graph_t * graph;
+  hg_quadtree_t * index;
+  double range;  // radius of the range queries
+  hg_hyperbolic_rgg_policy * hyperbolic_rgg;
+  hg_angular_rgg_policy * angular_rgg;
+};
+
+
+hg_implicit_graph_t * hg_implicit_graph_create(hg_graph_t * graph) {
+  if(graph == NULL) {
+    hg_log_err("Null graph provided.");
+    return NULL;
+  }
+  hg_graph_type gt = (*graph)[boost::graph_bundle].type;
+  if(gt != HYPERBOLIC_RGG && gt != ANGULAR_RGG) {
+    hg_log_warn("Implicit graphs are available for threshold models only (hyperbolic and angular rgg)");
+    return NULL;
+  }
+  hg_implicit_graph_t * ig = new hg_implicit_graph_t;
+  ig->graph = graph;
+  ig->hyperbolic_rgg = NULL;
+  ig->angular_rgg = NULL;
+  hg_algorithm_parameters_t p;
+  hg_get_internal_parameters(graph, p);
+  if(gt == HYPERBOLIC_RGG) {
+    ig->hyperbolic_rgg = new hg_hyperbolic_rgg_policy(graph, p);
+    hg_compact_model(*ig->hyperbolic_rgg, graph);
+    ig->range = p.radius;
+  }
+  else {
+    ig->angular_rgg = new hg_angular_rgg_policy(graph, p);
+    hg_compact_model(*ig->angular_rgg, graph);
+    ig->range = HG_PI * (*graph)[boost::graph_bundle].expected_degree / 
+      (double) (*graph)[boost::graph_bundle].expected_n;
+  }
+  // margin for rounding errors, the model decides on the candidates
+  ig->range += 1e-9 * (1 + ig->range);
+  ig->index = hg_quadtree_build(graph);
+  return ig;
 }
 
 
-hg_graph_t * hg_erdos_renyi(const int n, const double k_bar, 			     
-			    const double zeta, const int seed, 
-			    bool verbose) {
+hg_implicit_graph_t * hg_implicit_graph_generator(const int n, const double k_bar, 
+						  const double exp_gamma, const double t, 
+						  const double zeta, const int seed, 
+						  bool verbose) {
+  hg_graph_type gt = hg_infer_hg_type(exp_gamma, t);
+  if(gt != HYPERBOLIC_RGG && gt != ANGULAR_RGG) {
+    hg_log_warn("Implicit graphs are available for threshold models only (hyperbolic and angular rgg)");
+    return NULL;
+  }
   if(verbose) {
-    cout << "-> Erdos-Renyi Graph" << endl << endl;
+    cout << "-> " << (gt == HYPERBOLIC_RGG ? "Hyperbolic" : "Angular")
+	 << " Random Geometric Graph (implicit links)" << endl << endl;
   }
-  hg_graph_t * graph = new hg_graph_t(n);
+  hg_algorithm_parameters_t p;
+  hg_graph_t * graph = hg_new_graph(n, k_bar, (gt == HYPERBOLIC_RGG) ? exp_gamma : HG_INF_GAMMA,
+				    0 /* t = 0 */, zeta, seed, gt, p);
   if(graph == NULL) {
-    hg_log_warn("Unable to allocate memory for graph object");
     return NULL;
   }
-  // init graph
-  hg_init_graph(graph, n, k_bar, HG_INF_GAMMA /* exp_gamma = inf */, HG_INF_TEMPERATURE /* t = inf */,
-		zeta, seed, ERDOS_RENYI);
-  // computing internal parameters
-  hg_debug("\tInternal parameters computation");
-  hg_algorithm_parameters_t p;
-  p.radius = HG_INF_RADIUS; 
-  p.alpha = -1; // not relevant for current model
-  p.eta = -1; // not relevant for current model
-  hg_debug("\t\tradius: %d (INF)", HG_INF_RADIUS);
+  HG_Profile::end();
+  HG_Profile::begin("coordinates");
+  // same coordinates as the graph generated with the same seed
   hg_assign_coordinates(graph, p);
-  hg_coordinate_t c1, c2;
-  int id, other_id;
-  hg_debug("\tCreating links");
-  for(id = 0; id < (*graph)[boost::graph_bundle].expected_n; id++) {
-    c1 = hg_get_coordinate(graph, id);
-    for(other_id = id+1; other_id < (*graph)[boost::graph_bundle].expected_n; other_id++) {
-      c2 = hg_get_coordinate(graph, other_id);      
-      if(HG_Random::get_random_01_value() < hg_connection_probability_er(graph, c1, c2)) {
-	add_edge(id, other_id, *graph);
-	hg_debug("\t\tNew link: %d - %d ", id, other_id);
-      }
+  HG_Profile::end();
+  HG_Profile::begin("index");
+  hg_implicit_graph_t * ig = hg_implicit_graph_create(graph);
+  HG_Profile::end();
+  return ig;
+}
+
+
+hg_implicit_graph_t * hg_read_implicit_graph(const string filename) {
+  hg_graph_t * graph = hg_read_graph(filename, false);
+  if(graph == NULL) {
+    return NULL;
+  }
+  hg_implicit_graph_t * ig = hg_implicit_graph_create(graph);
+  if(ig == NULL) {
+    delete graph;
+  }
+  return ig;
+}
+
+
+const hg_graph_t * hg_implicit_graph_coordinates(const hg_implicit_graph_t * ig) {
+  return ig->graph;
+}
+
+
+bool hg_implicit_graph_adjacent(const hg_implicit_graph_t * ig, const unsigned int id1,
+				const unsigned int id2) {
+  if(id1 == id2) {
+    return false;
+  }
+  const hg_coordinate_t & c1 = (*ig->graph)[id1];
+  const hg_coordinate_t & c2 = (*ig->graph)[id2];
+  if(ig->hyperbolic_rgg != NULL) {
+    return hg_linked(*ig->hyperbolic_rgg, 0, id1, c1, id2, c2);
+  }
+  return hg_linked(*ig->angular_rgg, 0, id1, c1, id2, c2);
+}
+
+
+void hg_implicit_graph_neighbours(const hg_implicit_graph_t * ig, const unsigned int id,
+				  vector<unsigned int> & result) {
+  hg_quadtree_range(ig->index, (*ig->graph)[id], ig->range, result);
+  unsigned int i, k = 0;
+  for(i = 0; i < result.size(); i++) {
+    if(hg_implicit_graph_adjacent(ig, id, result[i])) {
+      result[k++] = result[i];
     }
   }
-  return graph;
+  result.resize(k);
+}
+
+
+void hg_implicit_graph_free(hg_implicit_graph_t * ig) {
+  if(ig == NULL) {
+    return;
+  }
+  hg_quadtree_free(ig->index);
+  delete ig->hyperbolic_rgg;
+  delete ig->angular_rgg;
+  delete ig->graph;
+  delete ig;
 }
 
 
@@ -30,11 +30,28 @@
 #include "hg_utils.h"
 #include "hg_random.h"
 #include "hg_debug.h"
-#include <iomanip> 
+#include <iomanip>
+#include <queue> 
 
 
 
-hg_graph_t * hg_read_graph(const string filename) {
+hg_graph_t * hg_create_graph(const int n) {
+  hg_arena_t * arena = hg_arena_new();
+  hg_graph_t * g;
+  {
+    hg_arena_scope scope(arena);
+    g = new hg_graph_t(n);
+  }
+  // the containers of g hold the arena from now on
+  hg_arena_free(arena);
+  return g;
+}
+
+
+hg_graph_t * hg_read_graph(const string filename, bool read_links) {
+  if(hg_has_extension(filename, ".hgc")) {
+    return hg_read_compressed_graph(filename, read_links);
+  }
   // graph_t pointer
   hg_graph_t *g = NULL;
   // graph generation parameters
@@ -45,40 +62,50 @@ hg_graph_t * hg_read_graph(const string filename) {
   // coordinates
   double radial;
   double angular;
-  // opening file
-  ifstream file;
+  // opening file (decompressed on the fly if .gz)
+  istream * file = hg_open_input_file(filename);
   int expected_n;
 
-  file.open(filename.c_str(), ios::in);
-  if(!file.fail() and file.is_open()) {
+  if(file != NULL) {
     // reading first line
-    file >> par >> expected_n;
-    g = new hg_graph_t(expected_n);
+    *file >> par >> expected_n;
+    g = hg_create_graph(expected_n);
     (*g)[boost::graph_bundle].expected_n = expected_n;
-    file >> par >> (*g)[boost::graph_bundle].temperature;
-    file >> par >> (*g)[boost::graph_bundle].expected_gamma;
-    file >> par >> (*g)[boost::graph_bundle].expected_degree;
-    file >> par >> (*g)[boost::graph_bundle].zeta_eta;
-    file >> par >> (*g)[boost::graph_bundle].seed;
-    file >> par >> (*g)[boost::graph_bundle].starting_id;
+    *file >> par >> (*g)[boost::graph_bundle].temperature;
+    *file >> par >> (*g)[boost::graph_bundle].expected_gamma;
+    *file >> par >> (*g)[boost::graph_bundle].expected_degree;
+    *file >> par >> (*g)[boost::graph_bundle].zeta_eta;
+    *file >> par >> (*g)[boost::graph_bundle].seed;
+    *file >> par >> (*g)[boost::graph_bundle].starting_id;
     // reading coordinates
     for(i = 0; i < expected_n; i++) {
-      file >> node1 >> radial >> angular;
+      *file >> node1 >> radial >> angular;
       (*g)[i].r = radial;
       (*g)[i].theta = angular;
     }
     // reading links
     unsigned int starting_id = (*g)[boost::graph_bundle].starting_id;
-    while(file >> node1 >> node2) {
-      add_edge(node1-starting_id, node2-starting_id, *g);
+    hg_link_buffer_t links;
+    long invalid = 0;
+    while(read_links && *file >> node1 >> node2) {
+      long id1 = (long) node1 - starting_id;
+      long id2 = (long) node2 - starting_id;
+      if(id1 < 0 || id1 >= expected_n || id2 < 0 || id2 >= expected_n) {
+	invalid++;
+	continue;
+      }
+      links.push_back(make_pair((int) id1, (int) id2));
+    }
+    if(invalid > 0) {
+      hg_log_err("%ld links of %s have a node id out of [%u, %u), skipped",
+		 invalid, filename.c_str(), starting_id, starting_id + expected_n);
     }
+    hg_add_edges(g, links);
   }
   else {
-    // warning
-    hg_log_err("File %s cannot be opened", filename.c_str());
     return NULL;
   }
-  file.close();
+  delete file;
   // infer graph type from parameters 
   (*g)[boost::graph_bundle].type = hg_infer_hg_type(g);
   return g; 
@@ -86,50 +113,332 @@ hg_graph_t * hg_read_graph(const string filename) {
 
 
 
+void hg_print_header(ostream & file, const hg_graph_t *g) {
+  file << std::setprecision(10) << std::fixed;
+  // hg_graph parameters
+  file << "N" << "\t" << (*g)[boost::graph_bundle].expected_n << "\t";
+  file << "T" << "\t" << (*g)[boost::graph_bundle].temperature << "\t";
+  file << "G" << "\t" << (*g)[boost::graph_bundle].expected_gamma << "\t";
+  file << "K" << "\t" << (*g)[boost::graph_bundle].expected_degree << "\t";
+  if((*g)[boost::graph_bundle].temperature >= HG_INF_TEMPERATURE &&
+     (*g)[boost::graph_bundle].expected_gamma < HG_INF_GAMMA) {
+    file << "eta" << "\t" << (*g)[boost::graph_bundle].zeta_eta << "\t";
+  }
+  else {
+    file << "Z" << "\t" << (*g)[boost::graph_bundle].zeta_eta << "\t";
+  }
+  file << "S" << "\t" << (*g)[boost::graph_bundle].seed << "\t";
+  file << "I" << "\t" << (*g)[boost::graph_bundle].starting_id << endl;
+}
+
+
+void hg_print_coordinates(ostream & file, const hg_graph_t *g, const unsigned int first_id) {
+  unsigned int starting_id = (*g)[boost::graph_bundle].starting_id;
+  hg_graph_t::vertex_iterator vertexIt, vertexEnd;
+  boost::tie(vertexIt, vertexEnd) = vertices(*g);
+  for (vertexIt += first_id; vertexIt != vertexEnd; ++vertexIt) { 
+    file << *vertexIt + starting_id << "\t";
+    file << (*g)[*vertexIt].r << "\t";
+    file << (*g)[*vertexIt].theta << endl;
+  }
+}
+
+
 void hg_print_graph(const hg_graph_t *g, const string filename) {
 
   if(g == NULL) {
     hg_log_err("Warning: empty data structure, no file written");
     return;
   }
-  ofstream file;
-
-  file.open(filename.c_str(), ios::out);
-  if(!file.fail() and file.is_open()) {
-    file << std::setprecision(10) << std::fixed;
-    // hg_graph parameters
-    file << "N" << "\t" << (*g)[boost::graph_bundle].expected_n << "\t";
-    file << "T" << "\t" << (*g)[boost::graph_bundle].temperature << "\t";
-    file << "G" << "\t" << (*g)[boost::graph_bundle].expected_gamma << "\t";
-    file << "K" << "\t" << (*g)[boost::graph_bundle].expected_degree << "\t";
-    if((*g)[boost::graph_bundle].temperature >= HG_INF_TEMPERATURE &&
-       (*g)[boost::graph_bundle].expected_gamma < HG_INF_GAMMA) {
-      file << "eta" << "\t" << (*g)[boost::graph_bundle].zeta_eta << "\t";
-    }
-    else {
-      file << "Z" << "\t" << (*g)[boost::graph_bundle].zeta_eta << "\t";
-    }
-    file << "S" << "\t" << (*g)[boost::graph_bundle].seed << "\t";
-    file << "I" << "\t" << (*g)[boost::graph_bundle].starting_id << endl;
+  if(hg_has_extension(filename, ".hgc")) {
+    hg_print_compressed_graph(g, filename);
+    return;
+  }
+  // compressed on the fly if .gz
+  ostream * file = hg_open_output_file(filename);
+  if(file != NULL) {
+    hg_print_header(*file, g);
     // hg_graph vertex coordinates
-    unsigned int starting_id = (*g)[boost::graph_bundle].starting_id;
-    hg_graph_t::vertex_iterator vertexIt, vertexEnd;
-    boost::tie(vertexIt, vertexEnd) = vertices(*g);
-    for (; vertexIt != vertexEnd; ++vertexIt) { 
-      file << *vertexIt + starting_id << "\t";
-      file << (*g)[*vertexIt].r << "\t";
-      file << (*g)[*vertexIt].theta << endl;
-    }
+    hg_print_coordinates(*file, g, 0);
     // hg_graph edgelist
+    unsigned int starting_id = (*g)[boost::graph_bundle].starting_id;
     hg_graph_t::edge_iterator edgeIt, edgeEnd;
     boost::tie(edgeIt, edgeEnd) = edges(*g);
     for (; edgeIt != edgeEnd; ++edgeIt) { 
+      *file << source(*edgeIt, *g) + starting_id << "\t";
+      *file << target(*edgeIt, *g) + starting_id << endl;
+    }
+    if(!hg_close_output_file(file)) {
+      hg_log_err("File %s: write error", filename.c_str());
+    }
+  }
+  return;
+}
+
+
+bool hg_print_grown_graph(const hg_graph_t *g, const int old_n,
+			  const string old_filename, const string filename) {
+  if(g == NULL) {
+    hg_log_err("Warning: empty data structure, no file written");
+    return false;
+  }
+  // either file may be .gz, a .hgc file is decoded (see hg_stream_open)
+  bool compressed = hg_has_extension(old_filename, ".hgc");
+  istream * old_file = NULL;
+  hg_stream_t * old_stream = NULL;
+  hg_parameters_t old_par;
+  if(compressed) {
+    old_stream = hg_stream_open(old_filename, old_par);
+  }
+  else {
+    old_file = hg_open_input_file(old_filename);
+  }
+  if(old_file == NULL && old_stream == NULL) {
+    return false;
+  }
+  ostream * output = hg_open_output_file(filename);
+  if(output == NULL) {
+    delete old_file;
+    hg_stream_close(old_stream);
+    return false;
+  }
+  ostream & file = *output;
+  unsigned int starting_id = (*g)[boost::graph_bundle].starting_id;
+  hg_print_header(file, g);
+  if(compressed) {
+    // coordinates of g, then the old links in text
+    hg_print_coordinates(file, g, 0);
+    unsigned int node1, node2;
+    while(hg_stream_read_link(old_stream, node1, node2)) {
+      file << node1 + starting_id << "\t" << node2 + starting_id << "\n";
+    }
+    hg_stream_close(old_stream);
+  }
+  else {
+    // new parameters, then the old coordinates as they are
+    string line;
+    int i;
+    getline(*old_file, line);
+    for(i = 0; i < old_n && getline(*old_file, line); i++) {
+      file << line << "\n";
+    }
+    hg_print_coordinates(file, g, old_n);
+    // old links: the rest of the file is copied in blocks
+    vector<char> buffer(1 << 20);
+    while(old_file->read(&buffer[0], buffer.size()) || old_file->gcount() > 0) {
+      file.write(&buffer[0], old_file->gcount());
+    }
+    delete old_file;
+  }
+  // links involving the new nodes
+  hg_graph_t::edge_iterator edgeIt, edgeEnd;
+  boost::tie(edgeIt, edgeEnd) = edges(*g);
+  for (; edgeIt != edgeEnd; ++edgeIt) { 
+    if((int) source(*edgeIt, *g) >= old_n || (int) target(*edgeIt, *g) >= old_n) {
       file << source(*edgeIt, *g) + starting_id << "\t";
       file << target(*edgeIt, *g) + starting_id << endl;
     }
   }
-  file.close();
-  return;
+  if(!hg_close_output_file(output)) {
+    hg_log_err("File %s: write error", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+/* shard and number of shards of a file named <name>.shard<i>of<N>.hg
+ * (shards are text files, .hgc files cannot be merged) */
+static bool hg_get_shard(const string & filename, unsigned int & shard,
+			 unsigned int & num_shards) {
+  size_t pos = filename.rfind(".shard");
+  char next = 0;
+  return pos != string::npos &&
+    sscanf(filename.c_str() + pos, ".shard%uof%u%c", &shard, &num_shards, &next) == 3 &&
+    next == '.' && shard < num_shards && !hg_has_extension(filename, ".hgc");
+}
+
+
+bool hg_merge_shards(const vector<string> & shard_files, const string filename) {
+  if(shard_files.empty()) {
+    hg_log_err("No shard provided");
+    return false;
+  }
+  unsigned int s, num_shards = shard_files.size();
+  // each of the N shards exactly once
+  vector<bool> found(num_shards, false);
+  for(s = 0; s < num_shards; s++) {
+    unsigned int shard, total;
+    if(!hg_get_shard(shard_files[s], shard, total)) {
+      hg_log_err("File %s: not a shard (<name>.shard<i>of<N>.hg)", shard_files[s].c_str());
+      return false;
+    }
+    if(total != num_shards) {
+      hg_log_err("File %s: one of %u shards, %u files provided", shard_files[s].c_str(), total, num_shards);
+      return false;
+    }
+    if(found[shard]) {
+      hg_log_err("File %s: shard %u provided twice", shard_files[s].c_str(), shard);
+      return false;
+    }
+    found[shard] = true;
+  }
+  // the header and the coordinates of the first shard are copied as they are
+  istream * first_file = hg_open_input_file(shard_files[0]);
+  if(first_file == NULL) {
+    return false;
+  }
+  string header, line;
+  getline(*first_file, header);
+  // links are read through a stream per shard
+  vector<hg_stream_t *> streams(num_shards, (hg_stream_t *) NULL);
+  vector<hg_parameters_t> par(num_shards);
+  bool ok = true;
+  for(s = 0; s < num_shards && ok; s++) {
+    streams[s] = hg_stream_open(shard_files[s], par[s]);
+    ok = (streams[s] != NULL);
+    if(ok && (par[s].expected_n != par[0].expected_n || par[s].seed != par[0].seed ||
+	      par[s].temperature != par[0].temperature || 
+	      par[s].expected_gamma != par[0].expected_gamma ||
+	      par[s].expected_degree != par[0].expected_degree ||
+	      par[s].zeta_eta != par[0].zeta_eta || par[s].starting_id != par[0].starting_id)) {
+      hg_log_err("File %s: parameters differ from %s", shard_files[s].c_str(), shard_files[0].c_str());
+      ok = false;
+    }
+  }
+  ostream * output = NULL;
+  if(ok) {
+    output = hg_open_output_file(filename);
+    ok = (output != NULL);
+  }
+  if(ok) {
+    ostream & file = *output;
+    file << header << "\n";
+    int i;
+    for(i = 0; i < par[0].expected_n && getline(*first_file, line); i++) {
+      file << line << "\n";
+    }
+    // k-way merge of the links (each shard is sorted by (node1, node2))
+    typedef pair<pair<unsigned int, unsigned int>, unsigned int> hg_shard_link_t;
+    priority_queue<hg_shard_link_t, vector<hg_shard_link_t>, greater<hg_shard_link_t> > links;
+    unsigned int node1, node2;
+    for(s = 0; s < num_shards; s++) {
+      if(hg_stream_read_link(streams[s], node1, node2)) {
+	links.push(make_pair(make_pair(node1, node2), s));
+      }
+    }
+    unsigned int starting_id = par[0].starting_id;
+    while(!links.empty()) {
+      hg_shard_link_t l = links.top();
+      links.pop();
+      file << l.first.first + starting_id << "\t" << l.first.second + starting_id << "\n";
+      if(hg_stream_read_link(streams[l.second], node1, node2)) {
+	links.push(make_pair(make_pair(node1, node2), l.second));
+      }
+    }
+    if(!hg_close_output_file(output)) {
+      hg_log_err("File %s: write error", filename.c_str());
+      ok = false;
+    }
+  }
+  delete first_file;
+  for(s = 0; s < num_shards; s++) {
+    if(streams[s] != NULL) {
+      hg_stream_close(streams[s]);
+    }
+  }
+  return ok;
+}
+
+
+hg_csr_t * hg_get_csr(const hg_graph_t *g) {
+  if(g == NULL) {
+    hg_log_err("Null graph provided.");
+    return NULL;
+  }
+  hg_csr_t * csr = new hg_csr_t;
+  long n = num_vertices(*g);
+  long id;
+  // offsets are the prefix sum of the degrees
+  csr->offsets.resize(n+1);
+  csr->offsets[0] = 0;
+  for(id = 0; id < n; id++) {
+    csr->offsets[id+1] = csr->offsets[id] + out_degree(id, *g);
+  }
+  csr->neighbours.resize(csr->offsets[n]);
+  // each node fills its own slice of neighbours, setS
+  // already returns the adjacent vertices sorted by id
+#pragma omp parallel for schedule(dynamic, 1024)
+  for(id = 0; id < n; id++) {
+    size_t pos = csr->offsets[id];
+    hg_graph_t::adjacency_iterator neighbourIt, neighbourEnd;
+    boost::tie(neighbourIt, neighbourEnd) = adjacent_vertices(id, *g);
+    for (; neighbourIt != neighbourEnd; ++neighbourIt) {
+      csr->neighbours[pos++] = *neighbourIt;
+    }
+  }
+  return csr;
+}
+
+
+hg_csr_t * hg_read_csr(const string filename) {
+  if(hg_has_extension(filename, ".hgc")) {
+    hg_graph_t * g = hg_read_graph(filename);
+    if(g == NULL) {
+      return NULL;
+    }
+    hg_csr_t * csr = hg_get_csr(g);
+    delete g;
+    return csr;
+  }
+  hg_parameters_t par;
+  hg_stream_t * s = hg_stream_open(filename, par);
+  if(s == NULL) {
+    return NULL;
+  }
+  long n = par.expected_n;
+  long id;
+  unsigned int node1, node2;
+  // both directions of each link, then counting sort by source
+  vector<pair<unsigned int, unsigned int> > links;
+  while(hg_stream_read_link(s, node1, node2)) {
+    if(node1 >= n || node2 >= n) continue;
+    links.push_back(make_pair(node1, node2));
+  }
+  hg_stream_close(s);
+  hg_csr_t * csr = new hg_csr_t;
+  csr->offsets.assign(n+1, 0);
+  size_t i;
+  for(i = 0; i < links.size(); i++) {
+    csr->offsets[links[i].first + 1]++;
+    csr->offsets[links[i].second + 1]++;
+  }
+  for(id = 0; id < n; id++) {
+    csr->offsets[id+1] += csr->offsets[id];
+  }
+  vector<size_t> pos(csr->offsets.begin(), csr->offsets.end() - 1);
+  csr->neighbours.resize(csr->offsets[n]);
+  for(i = 0; i < links.size(); i++) {
+    csr->neighbours[pos[links[i].first]++] = links[i].second;
+    csr->neighbours[pos[links[i].second]++] = links[i].first;
+  }
+  vector<pair<unsigned int, unsigned int> >().swap(links);
+  // sorted lists without duplicates (as the setS adjacency)
+  size_t k = 0;
+  for(id = 0; id < n; id++) {
+    size_t first = csr->offsets[id];
+    size_t last = csr->offsets[id+1];
+    sort(csr->neighbours.begin() + first, csr->neighbours.begin() + last);
+    csr->offsets[id] = k;
+    for(i = first; i < last; i++) {
+      if(i == first || csr->neighbours[i] != csr->neighbours[i-1]) {
+	csr->neighbours[k++] = csr->neighbours[i];
+      }
+    }
+  }
+  csr->offsets[n] = k;
+  csr->neighbours.resize(k);
+  return csr;
 }
 
 
@@ -144,6 +453,17 @@ double hg_rand_01_wrapper() {
 }
 
 
+void hg_use_pair_random_generator(const bool enable) {
+  HG_Random::set_pair_mode(enable);
+}
+
+
+double hg_pair_rand_01(const unsigned int seed, const unsigned int i,
+		       const unsigned int j) {
+  return HG_Random::get_pair_random_01_value(seed, i, j);
+}
+
+
 hg_graph_t * hg_graph_generator(const int n, const double k_bar, 
 				const double exp_gamma, const double t, 
 				const double zeta, const int seed, 
@@ -45,22 +45,134 @@
 using namespace std;
 
 
+//  ============= hg_graph allocation  ============= 
+
+/* new graph of n nodes with an arena of its own (see hg_arena.h):
+ * its out-edge sets and its edge list are allocated in the arena,
+ * which is freed when the graph is deleted */
+hg_graph_t * hg_create_graph(const int n);
+
+
 //  ============= hg_graph I/O functions  ============= 
 
 /* load a graph from file in .hg format
  * see the README file for more details on
- * the hg format
+ * the hg format. If read_links is false only
+ * the parameters and the coordinates are loaded.
+ * Files having the .hgc extension are read with
+ * hg_read_compressed_graph, files having the .gz
+ * extension (e.g. graph.hg.gz) are decompressed
  */
-hg_graph_t * hg_read_graph(const string filename);
+hg_graph_t * hg_read_graph(const string filename, bool read_links = true);
 
 
 /* print a graph to file in .hg format
  * see the README file for more details on
- * the hg format
+ * the hg format. If filename has the .hgc
+ * extension the compressed format is used, if
+ * it has the .gz extension the file is gzipped
  */
 void hg_print_graph(const hg_graph_t *g, const string filename);
 
 
+/* compressed binary format (.hgc): coordinates are stored 
+ * as they are in memory and the sorted neighbour lists are
+ * gap encoded varints (see hg_compressed.cpp), nodes close
+ * in the space should have close ids (see hg_relabel_graph).
+ * Links are loaded sorted by (node1, node2)
+ */
+bool hg_print_compressed_graph(const hg_graph_t *g, const string filename);
+
+hg_graph_t * hg_read_compressed_graph(const string filename, bool read_links = true);
+
+/* random access to a .hgc file: the coordinates are loaded,
+ * the neighbours of a node are read from the file decoding 
+ * only the block of nodes that contains it */
+hg_compressed_t * hg_compressed_open(const string filename, hg_parameters_t & par);
+
+bool hg_compressed_coordinate(const hg_compressed_t * c, const unsigned int id,
+			      hg_coordinate_t & coordinate);
+
+/* neighbours of node id, sorted by id */
+bool hg_compressed_neighbours(hg_compressed_t * c, const unsigned int id,
+			      vector<unsigned int> & neighbours);
+
+void hg_compressed_close(hg_compressed_t * c);
+
+
+/* print to filename a graph obtained by adding nodes to the 
+ * graph stored in old_filename (see hg_graph_grow): nodes 
+ * with id < old_n and their links are copied from the old
+ * file as they are (decoded if it is a .hgc file), then the
+ * new coordinates and the links of g that involve a new
+ * node are added. filename is written in .hg format
+ */
+bool hg_print_grown_graph(const hg_graph_t *g, const int old_n,
+			  const string old_filename, const string filename);
+
+
+/* merge the .hg files of the shards of a graph (see hg_set_shard)
+ * in filename: the parameters and the coordinates are copied from
+ * the first shard, the links of all the shards are merged so that
+ * they are sorted as in the graph generated at once. Files are
+ * read sequentially, the graph is not loaded in memory. Shard i
+ * of N is named <name>.shard<i>of<N>.hg (.gz allowed), as the
+ * generator writes it. Returns false if a file cannot be opened,
+ * the parameters differ, or the files are not the N shards of
+ * the graph once each
+ */
+bool hg_merge_shards(const vector<string> & shard_files, const string filename);
+
+
+/* open a .hg (or .hg.gz) file for sequential reading: the graph is not
+ * built in memory, the parameters in the first line are
+ * returned in par, then coordinates and links can be read
+ * one at a time (node ids start from 0). .hgc files are read
+ * through hg_compressed_open, links sorted by (node1, node2).
+ * Returns NULL if the file cannot be opened
+ */
+hg_stream_t * hg_stream_open(const string filename, hg_parameters_t & par);
+
+/* read the next node coordinate, returns false when
+ * all the coordinates have been read */
+bool hg_stream_read_coordinate(hg_stream_t * s, unsigned int & id,
+			       hg_coordinate_t & c);
+
+/* read the next link (coordinates that have not been read
+ * yet are skipped), returns false at the end of the file */
+bool hg_stream_read_link(hg_stream_t * s, unsigned int & node1,
+			 unsigned int & node2);
+
+void hg_stream_close(hg_stream_t * s);
+
+
+/* build the CSR adjacency (see hg_formats.h) of the 
+ * graph provided, neighbour lists are sorted by id
+ */
+hg_csr_t * hg_get_csr(const hg_graph_t *g);
+
+/* read the links of a graph file in CSR format (32-bit ids, see
+ * hg_formats.h) without building the graph adjacency, the same as
+ * hg_get_csr(hg_read_graph(filename)) with a fraction of the memory.
+ * Returns NULL if the file cannot be read
+ */
+hg_csr_t * hg_read_csr(const string filename);
+
+
+/* copy of g whose node ids follow the order provided, so that
+ * nodes close in the space have close ids (and close positions
+ * in memory). permutation[new id] = old id, links are sorted by
+ * the new ids. Returns NULL if g is NULL
+ */
+hg_graph_t * hg_relabel_graph(const hg_graph_t * g, const hg_node_order order,
+			      vector<unsigned int> & permutation);
+
+/* write the permutation (one "<new id> <old id>" line per node,
+ * ids start from starting_id as in the .hg files) */
+bool hg_print_permutation(const vector<unsigned int> & permutation, 
+			  const unsigned int starting_id, const string filename);
+
+
 //  =============  Random generator functions  ============= 
 
 // Initialize random generator
@@ -70,6 +182,19 @@ void hg_init_random_generator(const unsigned int seed);
  * and returns a number between 0 and 1 */
 double hg_rand_01_wrapper();
 
+/* when enabled the generators decide on each pair (i,j) with a
+ * counter-based random number, a function of (seed, i, j) only
+ * (see hg_pair_rand_01), instead of the next number of the stream:
+ * links can then be recomputed one at a time and generated in 
+ * parallel (the graph does not depend on the number of threads).
+ * Coordinates are the same in both modes, links are not (but for
+ * hyperbolic and angular random geometric graphs) */
+void hg_use_pair_random_generator(const bool enable);
+
+/* uniform number in [0,1) of the pair (i,j), symmetric in i and j */
+double hg_pair_rand_01(const unsigned int seed, const unsigned int i,
+		       const unsigned int j);
+
 
 
 //  ============= graph's generation utilities  ============= 
@@ -85,6 +210,100 @@ hg_graph_t * hg_graph_generator(const int n, const double k_bar, const double ex
 				bool verbose = false);
 
 
+/* generate only a shard of the graphs: all the coordinates are
+ * generated, the nodes whose angular coordinate lies in the sector
+ * [2 pi shard / num_shards, 2 pi (shard + 1) / num_shards) belong
+ * to the shard, and only the links whose lower id endpoint belongs
+ * to the shard are created. Shards use pair random numbers (see 
+ * hg_use_pair_random_generator), hence the union of the links of 
+ * the shards is the graph generated with pair random numbers. 
+ * hg_set_shard(0, 1) restores the generation of the whole graph */
+void hg_set_shard(const int shard, const int num_shards);
+
+
+/* save checkpoints of the link creation of the next graphs generated
+ * (not by hg_graph_generator_to_file) in filename and filename.links,
+ * every interval seconds: the rows of the pair space done, the state
+ * of the random number stream and the links created so far. If resume
+ * is true the generation restarts from the last checkpoint, the graph
+ * is the same an uninterrupted generation produces. The files are
+ * removed once all the links are created. An empty filename disables
+ * the checkpoints */
+void hg_set_checkpoint(const string filename, const double interval, const bool resume);
+
+
+/* compact mode of the next graphs generated (hg_graph_generator,
+ * hg_graph_grow) and implicit graphs created: threshold models 
+ * (hyperbolic and angular rgg) decide the pairs on 32-bit float
+ * copies of the coordinates, and re-check in double precision the
+ * pairs close to the threshold, hence the links are exactly the 
+ * same as in the default mode while half the memory is read per 
+ * pair. The graph keeps its double coordinates: the mode saves
+ * memory bandwidth, not memory (the float copies replace the 
+ * double per-node arrays of the hyperbolic rgg, they are added
+ * in the angular rgg). The other models are not affected */
+void hg_set_compact(const bool compact);
+
+
+/* generate a graph as hg_graph_generator does and write it in filename 
+ * (the same file hg_print_graph writes, .gz allowed) while the links 
+ * are created: blocks of links are handed to an I/O thread that 
+ * formats and writes them, so writing overlaps with the generation
+ * and the links are never stored in memory. Returns the number of
+ * links written, -1 if the graph cannot be generated or written */
+long hg_graph_generator_to_file(const int n, const double k_bar, const double exp_gamma,
+				const double t, const double zeta, const int seed,
+				const string filename, bool verbose = false);
+
+
+/* add delta nodes to a graph: the new nodes get coordinates
+ * extracted with the parameters of the graph (seed is used
+ * to initialize the random generator) and only the pairs 
+ * involving a new node are evaluated. For threshold models
+ * (hyperbolic and angular rgg) the existing nodes are 
+ * indexed, so that only the pairs that can be linked are
+ * visited. The new links are appended to the graph
+ */
+hg_graph_t * hg_graph_grow(hg_graph_t * graph, const int delta, 
+			   const int seed, bool verbose = false);
+
+
+
+//  ============= implicit graphs  ============= 
+
+/* in hyperbolic and angular random geometric graphs two nodes are
+ * linked iff their distance is below a threshold, hence the links
+ * need not be stored: an implicit graph keeps the coordinates and a
+ * quadtree (see below) and computes the links of a node on demand.
+ * hg_implicit_graph_create takes ownership of g, its links (if any)
+ * are ignored. NULL is returned for the other models */
+hg_implicit_graph_t * hg_implicit_graph_create(hg_graph_t * g);
+
+/* same coordinates as hg_graph_generator with the same parameters,
+ * therefore the same links, but the links are not generated */
+hg_implicit_graph_t * hg_implicit_graph_generator(const int n, const double k_bar, 
+						  const double exp_gamma, const double t, 
+						  const double zeta, const int seed, 
+						  bool verbose = false);
+
+/* load the parameters and the coordinates of a .hg file, the
+ * links in the file (if any) are not read */
+hg_implicit_graph_t * hg_read_implicit_graph(const string filename);
+
+/* parameters and coordinates of the graph (it has no links), it can
+ * be used with hg_hyperbolic_distance or printed with hg_print_graph */
+const hg_graph_t * hg_implicit_graph_coordinates(const hg_implicit_graph_t * ig);
+
+bool hg_implicit_graph_adjacent(const hg_implicit_graph_t * ig, const unsigned int id1,
+				const unsigned int id2);
+
+/* neighbours of node id, sorted by id */
+void hg_implicit_graph_neighbours(const hg_implicit_graph_t * ig, const unsigned int id,
+				  vector<unsigned int> & result);
+
+void hg_implicit_graph_free(hg_implicit_graph_t * ig);
+
+
 
 //  ============= hyperbolic distance function  ============= 
 
@@ -99,4 +318,26 @@ double hg_hyperbolic_distance(const hg_graph_t * g,
 
 
 
+/* build a polar quadtree over the coordinates of g: cells are 
+ * split in angle and in radial area until they contain at most
+ * leaf_size nodes. The graph must not be modified while the 
+ * index is in use. Queries use hg_hyperbolic_distance, hence 
+ * they follow the geometry of the graph type */
+hg_quadtree_t * hg_quadtree_build(const hg_graph_t * g,
+				  const unsigned int leaf_size = 32);
+
+/* ids of the nodes at distance <= d from p, sorted by id */
+void hg_quadtree_range(const hg_quadtree_t * qt, const hg_coordinate_t & p,
+		       const double d, vector<unsigned int> & result);
+
+/* the k nodes closest to p as (distance, id) pairs, sorted by 
+ * distance (ties are broken by id) */
+void hg_quadtree_nearest(const hg_quadtree_t * qt, const hg_coordinate_t & p,
+			 const unsigned int k,
+			 vector<pair<double, unsigned int> > & result);
+
+void hg_quadtree_free(hg_quadtree_t * qt);
+
+
+
 #endif /* _HG_GRAPHS_LIB_H */
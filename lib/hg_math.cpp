@@ -27,6 +27,7 @@
 
 #include <stdlib.h>
 #include <limits>
+#include <map>
 #include <gsl/gsl_math.h>
 #include <gsl/gsl_monte.h>
 #include <gsl/gsl_monte_miser.h>
@@ -34,13 +35,18 @@
 #include <gsl/gsl_sf_hyperg.h>
 
 #include "hg_math.h"
+#include "hg_profile.h"
+#include "hg_counters.h"
+#include "hg_debug.h"
 
 static double rho(double alpha, double R, double r){
+  hg_count(HG_COUNTER_EXP);
   return alpha * exp(alpha * (r-R));
 }
 
 static double hg_heaviside(double zeta, double R, 
 			   double r1, double r2, double theta){
+  hg_count(HG_COUNTER_ACOSH);
   double x = (1/zeta)
     * acosh(cosh(zeta*r1)*cosh(zeta*r2)
 	    -sinh(zeta*r1)*sinh(zeta*r2)*cos(theta));
@@ -52,6 +58,8 @@ static double hg_heaviside(double zeta, double R,
 
 static double hg_fermi_dirac_std(double beta, double zeta, double R, 
 				 double r1, double r2, double theta){
+  hg_count(HG_COUNTER_ACOSH);
+  hg_count(HG_COUNTER_EXP);
   double x = (1/zeta) 
     * acosh(cosh(zeta*r1)*cosh(zeta*r2)
 	    -sinh(zeta*r1)*sinh(zeta*r2)*cos(theta));
@@ -61,6 +69,7 @@ static double hg_fermi_dirac_std(double beta, double zeta, double R,
 
 static double hg_fermi_dirac_scm(double eta, double R, 
 				 double r1, double r2){  
+  hg_count(HG_COUNTER_EXP);
   return 1 / (1 + exp((eta / 2.0) * (r1 + r2 - R)));
 }
 
@@ -197,6 +206,10 @@ double hg_get_R(hg_graph_t * graph, hg_algorithm_parameters_t & p){
   delete[] xl;
   delete[] xu;
 
+  HG_Profile::set("alpha", p.alpha);
+  HG_Profile::set("hg_get_R_iterations", it);
+  HG_Profile::set("hg_get_R_integral_calls", calls);
+  HG_Profile::set("R", mid);
   return mid;
 }
 
@@ -225,31 +238,142 @@ inline double hypergeometric_f(double a, double b,
   }
 }
 
+/* expected average degree of a soft_rgg graph as a function
+ * of lambda (it decreases monotonically) minus the target one */
+static double hg_lambda_degree_gap(double n, double k_bar, double temperature,
+				   double lambda){
+  return n * hypergeometric_f(1.0, temperature, 1.0 + temperature, -lambda) - k_bar;
+}
+
+
+/* initial guess from the large lambda expansion of hypergeometric_f
+ * (w = 1/(1+lambda) goes to 0):
+ *   T < 1:  f ~ T pi / sin(T pi) lambda^-T
+ *   T > 1:  f ~ T / (T-1) lambda^-1
+ *   T = 1:  f = log(1+lambda) / lambda  */
+static double hg_lambda_guess(double n, double k_bar, double temperature){
+  double ratio = n / k_bar;
+  if(temperature < 1) {
+    return pow(ratio * temperature * HG_PI / sin(temperature * HG_PI), 1.0 / temperature);
+  }
+  if(temperature > 1) {
+    return ratio * temperature / (temperature - 1.0);
+  }
+  return ratio * std::max(1.0, log(ratio));
+}
+
+
+// lambda values already computed, key is (n, (k_bar, T))
+typedef map<pair<double, pair<double, double> >, double> hg_lambda_cache_t;
+static hg_lambda_cache_t hg_lambda_cache;
+
+
 double hg_get_lambda(hg_graph_t * graph, hg_algorithm_parameters_t & p){
 
-  double beta = 1.0 / (*graph)[boost::graph_bundle].temperature;
+  double temperature = (*graph)[boost::graph_bundle].temperature;
   double n = (*graph)[boost::graph_bundle].expected_n;
   double k_bar = (*graph)[boost::graph_bundle].expected_degree;
-  
-  double res; // hypergeometric function result
+
+  pair<double, pair<double, double> > key = make_pair(n, make_pair(k_bar, temperature));
+  hg_lambda_cache_t::iterator cached = hg_lambda_cache.find(key);
+  if(cached != hg_lambda_cache.end()) {
+    HG_Profile::set("hg_get_lambda_iterations", 0);
+    HG_Profile::set("lambda", cached->second);
+    return cached->second;
+  }
+
   double eps = .001; // maximum error for the avg degree
-  double low = 1;
-  double high = DBL_MAX;
-  double mid;
+  const int max_expansions = 200;
+  const int max_iterations = 100;
+  int it = 0;
 
-  do{
-    // set midpoint
-    mid = (high + low) / 2.0;
+  // bracket the solution around the asymptotic guess: the gap
+  // is positive at low and negative at high (lambda > 0)
+  double guess = hg_lambda_guess(n, k_bar, temperature);
+  double low = guess, high = guess;
+  double f_low = hg_lambda_degree_gap(n, k_bar, temperature, low);
+  double f_high = f_low;
+  while((f_low < 0 || isnan(f_low)) && it < max_expansions) {
+    low /= 2.0;
+    f_low = hg_lambda_degree_gap(n, k_bar, temperature, low);
+    ++it;
+  }
+  while((f_high > 0 || isnan(f_high)) && it < max_expansions) {
+    high *= 2.0;
+    f_high = hg_lambda_degree_gap(n, k_bar, temperature, high);
+    ++it;
+  }
+  if(isnan(f_low) || isnan(f_high) || f_low < 0 || f_high > 0) {
+    cerr << "Network cannot be generated. Try different parameters." << endl;
+    exit(1);
+  }
 
-    res = hypergeometric_f(1.0, 1.0/beta, 1.0 + 1.0/beta, -mid);
+  /* Brent's method on x = log(lambda): inverse quadratic 
+   * interpolation, secant or bisection steps, the bracket
+   * [a,b] always contains the solution */
+  double a = log(low), b = log(high), c = a;
+  double fa = f_low, fb = f_high, fc = fa;
+  double d = b - a, e = d;
+  int brent_it = 0;
+  while(abs(fb) > eps && brent_it < max_iterations) {
+    if((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+      c = a; fc = fa;
+      d = e = b - a;
+    }
+    if(abs(fc) < abs(fb)) {
+      a = b; b = c; c = a;
+      fa = fb; fb = fc; fc = fa;
+    }
+    double tol = 2.0 * std::numeric_limits<double>::epsilon() * abs(b) + 1e-15;
+    double m = 0.5 * (c - b);
+    if(abs(m) <= tol) {
+      break;
+    }
+    if(abs(e) >= tol && abs(fa) > abs(fb)) {
+      double s = fb / fa, q, r, t;
+      if(a == c) {
+	t = 2.0 * m * s;
+	q = 1.0 - s;
+      }
+      else {
+	q = fa / fc;
+	r = fb / fc;
+	t = s * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+	q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+      }
+      if(t > 0) {
+	q = -q;
+      }
+      else {
+	t = -t;
+      }
+      if(2.0 * t < std::min(3.0 * m * q - abs(tol * q), abs(e * q))) {
+	e = d;
+	d = t / q;
+      }
+      else {
+	d = m;
+	e = m;
+      }
+    }
+    else {
+      d = m;
+      e = m;
+    }
+    a = b;
+    fa = fb;
+    b += (abs(d) > tol) ? d : (m > 0 ? tol : -tol);
+    fb = hg_lambda_degree_gap(n, k_bar, temperature, exp(b));
+    ++brent_it;
+  }
 
-    if(n*res < k_bar)
-      high = mid;
-    else
-      low = mid;
-  
-    //cout << n*res << " - " << mid << endl;
-  }while(abs(n*res-k_bar) > eps || isnan(res));
-  
-  return mid;
+  if(isnan(fb) || abs(fb) > eps) {
+    hg_log_warn("lambda found with average degree error %f", abs(fb));
+  }
+
+  double lambda = exp(b);
+  hg_lambda_cache[key] = lambda;
+  HG_Profile::set("hg_get_lambda_iterations", it + brent_it);
+  HG_Profile::set("lambda", lambda);
+  return lambda;
 }
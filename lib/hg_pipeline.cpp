@@ -0,0 +1,219 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <vector>
+
+#include "hg_pipeline.h"
+#include "hg_utils.h"
+#include "hg_profile.h"
+#include "hg_debug.h"
+
+
+/* The generator (producer) and the I/O thread (consumer) share a
+ * ring of buffers: the producer swaps a full buffer into the ring
+ * and gets back the storage of an empty one, the consumer swaps the
+ * oldest buffer out of the ring and writes it. The lock is taken
+ * once per block of links and a thread waits only when the ring is 
+ * full (the disk is slower than the generator) or empty (the 
+ * generator is slower), so that writing overlaps with computation */
+#define HG_PIPELINE_BUFFERS 8
+
+struct struct_hg_link_pipeline {
+  const hg_graph_t * graph;
+  ostream * file;
+  string filename;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t queued;    // signalled when a buffer is queued (or at the end)
+  pthread_cond_t released;  // signalled when a buffer is released
+  hg_link_buffer_t buffers[HG_PIPELINE_BUFFERS];
+  unsigned int head;        // oldest buffer queued
+  unsigned int count;       // buffers queued
+  bool done;
+  bool ok;
+  long links;
+  // statistics
+  long producer_waits;
+  double io_time;
+};
+
+
+static double hg_pipeline_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+/* print value in decimal before end, returns the first digit */
+static inline char * hg_pipeline_format(unsigned long value, char * end) {
+  do {
+    *--end = '0' + value % 10;
+    value /= 10;
+  } while(value > 0);
+  return end;
+}
+
+
+/* same text as hg_print_graph: "<node1>\t<node2>\n" */
+static void hg_pipeline_write_links(hg_link_pipeline_t * p, 
+				    const hg_link_buffer_t & links,
+				    vector<char> & text) {
+  const unsigned long starting_id = (*p->graph)[boost::graph_bundle].starting_id;
+  char digits[24];
+  char * end = digits + sizeof(digits);
+  text.clear();
+  hg_link_buffer_t::const_iterator it;
+  for(it = links.begin(); it != links.end(); ++it) {
+    char * first = hg_pipeline_format(it->first + starting_id, end);
+    text.insert(text.end(), first, end);
+    text.push_back('\t');
+    first = hg_pipeline_format(it->second + starting_id, end);
+    text.insert(text.end(), first, end);
+    text.push_back('\n');
+  }
+  if(!text.empty()) {
+    p->file->write(&text[0], text.size());
+  }
+}
+
+
+static void * hg_pipeline_thread(void * arg) {
+  hg_link_pipeline_t * p = (hg_link_pipeline_t *) arg;
+  double start = hg_pipeline_time();
+  hg_print_header(*p->file, p->graph);
+  hg_print_coordinates(*p->file, p->graph, 0);
+  p->io_time += hg_pipeline_time() - start;
+  hg_link_buffer_t links;
+  vector<char> text;
+  bool ok = p->file->good();
+  while(ok) {
+    pthread_mutex_lock(&p->lock);
+    while(p->count == 0 && !p->done) {
+      pthread_cond_wait(&p->queued, &p->lock);
+    }
+    if(p->count == 0) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+    links.swap(p->buffers[p->head]);
+    p->head = (p->head + 1) % HG_PIPELINE_BUFFERS;
+    p->count--;
+    pthread_cond_signal(&p->released);
+    pthread_mutex_unlock(&p->lock);
+    start = hg_pipeline_time();
+    hg_pipeline_write_links(p, links, text);
+    p->io_time += hg_pipeline_time() - start;
+    p->links += links.size();
+    links.clear();
+    ok = p->file->good();
+  }
+  if(!ok) {
+    // the producer must not wait for a buffer any more
+    pthread_mutex_lock(&p->lock);
+    p->ok = false;
+    pthread_cond_signal(&p->released);
+    pthread_mutex_unlock(&p->lock);
+  }
+  return NULL;
+}
+
+
+hg_link_pipeline_t * hg_pipeline_start(const hg_graph_t * graph, const string filename) {
+  ostream * file = hg_open_output_file(filename);
+  if(file == NULL) {
+    return NULL;
+  }
+  hg_link_pipeline_t * p = new hg_link_pipeline_t;
+  p->graph = graph;
+  p->file = file;
+  p->filename = filename;
+  p->head = 0;
+  p->count = 0;
+  p->done = false;
+  p->ok = true;
+  p->links = 0;
+  p->producer_waits = 0;
+  p->io_time = 0;
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->queued, NULL);
+  pthread_cond_init(&p->released, NULL);
+  if(pthread_create(&p->thread, NULL, hg_pipeline_thread, p) != 0) {
+    hg_log_err("Unable to start the I/O thread");
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->queued);
+    pthread_cond_destroy(&p->released);
+    hg_close_output_file(file);
+    delete p;
+    return NULL;
+  }
+  return p;
+}
+
+
+void hg_pipeline_push(hg_link_pipeline_t * p, hg_link_buffer_t & links) {
+  if(links.empty()) {
+    return;
+  }
+  pthread_mutex_lock(&p->lock);
+  if(p->count == HG_PIPELINE_BUFFERS && p->ok) {
+    p->producer_waits++;
+    while(p->count == HG_PIPELINE_BUFFERS && p->ok) {
+      pthread_cond_wait(&p->released, &p->lock);
+    }
+  }
+  if(p->ok) {
+    links.swap(p->buffers[(p->head + p->count) % HG_PIPELINE_BUFFERS]);
+    p->count++;
+    pthread_cond_signal(&p->queued);
+  }
+  pthread_mutex_unlock(&p->lock);
+  // the buffer received back has been written already
+  links.clear();
+}
+
+
+long hg_pipeline_finish(hg_link_pipeline_t * p) {
+  pthread_mutex_lock(&p->lock);
+  p->done = true;
+  pthread_cond_signal(&p->queued);
+  pthread_mutex_unlock(&p->lock);
+  pthread_join(p->thread, NULL);
+  bool ok = hg_close_output_file(p->file) && p->ok;
+  if(!ok) {
+    hg_log_err("File %s: write error", p->filename.c_str());
+  }
+  HG_Profile::set("pipeline_io_thread_seconds", p->io_time);
+  HG_Profile::set("pipeline_producer_waits", p->producer_waits);
+  long links = ok ? p->links : -1;
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->queued);
+  pthread_cond_destroy(&p->released);
+  delete p;
+  return links;
+}
@@ -0,0 +1,58 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HG_PIPELINE_H
+#define _HG_PIPELINE_H
+
+#include "hg_formats.h"
+
+
+/* Pipelined output of a graph being generated: an I/O thread
+ * writes the header and the coordinates, then it formats and
+ * writes the blocks of links queued by the generator, in the
+ * same order, while the generation goes on */
+typedef struct struct_hg_link_pipeline hg_link_pipeline_t;
+
+// links queued at once by the generators
+#define HG_PIPELINE_BLOCK_SIZE (1 << 16)
+
+/* open filename (.gz allowed, see hg_open_output_file) and start
+ * the I/O thread, NULL if the file cannot be opened. The graph 
+ * coordinates must not change until hg_pipeline_finish */
+hg_link_pipeline_t * hg_pipeline_start(const hg_graph_t * graph, const string filename);
+
+/* queue the links (pairs of node ids) for writing: the content of
+ * links is moved to the pipeline and links is left empty, the call
+ * blocks while all the buffers of the pipeline are full */
+void hg_pipeline_push(hg_link_pipeline_t * p, hg_link_buffer_t & links);
+
+/* wait for the I/O thread to write the queued links and close the
+ * file, the number of links written is returned (-1 if an error
+ * occurred) and the pipeline statistics are added to the profile */
+long hg_pipeline_finish(hg_link_pipeline_t * p);
+
+
+#endif /* _HG_PIPELINE_H */
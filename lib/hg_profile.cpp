@@ -0,0 +1,191 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <fstream>
+#include <iomanip>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "hg_profile.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+bool HG_Profile::enabled = false;
+vector<hg_profile_phase_t> HG_Profile::phases;
+vector< pair<string, double> > HG_Profile::parameters;
+vector< pair<string, string> > HG_Profile::labels;
+hg_profile_phase_t HG_Profile::current;
+
+
+static double hg_wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+// cpu time of all the threads of the process
+static double hg_cpu_time(const struct rusage & usage) {
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+}
+
+
+void HG_Profile::enable(const bool & on) {
+  enabled = on;
+}
+
+
+void HG_Profile::begin(const string & phase) {
+  if(!enabled) {
+    return;
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  current.name = phase;
+  current.wall_time = hg_wall_time();
+  current.cpu_time = hg_cpu_time(usage);
+  current.peak_rss = 0;
+#ifdef HG_COUNTERS_ON
+  current.counters = hg_counters_get();
+  current.perf = hg_perf_read();
+#endif
+}
+
+
+void HG_Profile::end() {
+  if(!enabled) {
+    return;
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  hg_profile_phase_t p = current;
+  p.wall_time = hg_wall_time() - current.wall_time;
+  p.cpu_time = hg_cpu_time(usage) - current.cpu_time;
+  p.peak_rss = usage.ru_maxrss; // kB on Linux
+#ifdef HG_COUNTERS_ON
+  hg_counters_t counters = hg_counters_get();
+  hg_perf_sample_t perf = hg_perf_read();
+  int c;
+  for(c = 0; c < HG_NUM_COUNTERS; c++) {
+    p.counters.value[c] = counters.value[c] - current.counters.value[c];
+  }
+  p.perf.cycles = (perf.cycles < 0) ? -1 : perf.cycles - current.perf.cycles;
+  p.perf.cache_misses = (perf.cache_misses < 0) ? -1 : perf.cache_misses - current.perf.cache_misses;
+#endif
+  phases.push_back(p);
+  hg_debug("phase %s: %f s", p.name.c_str(), p.wall_time);
+}
+
+
+void HG_Profile::set(const string & name, const double & value) {
+  if(!enabled) {
+    return;
+  }
+  vector< pair<string, double> >::iterator it;
+  for(it = parameters.begin(); it != parameters.end(); ++it) {
+    if(it->first == name) {
+      it->second = value;
+      return;
+    }
+  }
+  parameters.push_back(make_pair(name, value));
+}
+
+
+void HG_Profile::set(const string & name, const string & value) {
+  if(!enabled) {
+    return;
+  }
+  vector< pair<string, string> >::iterator it;
+  for(it = labels.begin(); it != labels.end(); ++it) {
+    if(it->first == name) {
+      it->second = value;
+      return;
+    }
+  }
+  labels.push_back(make_pair(name, value));
+}
+
+
+bool HG_Profile::write(const string & filename) {
+  ofstream file;
+  file.open(filename.c_str(), ios::out);
+  if(file.fail() or !file.is_open()) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return false;
+  }
+  unsigned int i;
+  double wall = 0;
+  double cpu = 0;
+  long rss = 0;
+  file << std::setprecision(10);
+  file << "{" << endl;
+  file << "  \"phases\": [" << endl;
+  for(i = 0; i < phases.size(); i++) {
+    file << "    { \"name\": \"" << phases[i].name << "\", ";
+    file << "\"wall_time\": " << phases[i].wall_time << ", ";
+    file << "\"cpu_time\": " << phases[i].cpu_time << ", ";
+    file << "\"peak_rss_kb\": " << phases[i].peak_rss;
+#ifdef HG_COUNTERS_ON
+    int c;
+    for(c = 0; c < HG_NUM_COUNTERS; c++) {
+      file << ", \"" << hg_counter_name(c) << "\": " << phases[i].counters.value[c];
+    }
+    if(phases[i].perf.cycles >= 0) {
+      file << ", \"cycles\": " << phases[i].perf.cycles;
+    }
+    if(phases[i].perf.cache_misses >= 0) {
+      file << ", \"cache_misses\": " << phases[i].perf.cache_misses;
+    }
+#endif
+    file << " }";
+    file << (i + 1 < phases.size() ? "," : "") << endl;
+    wall += phases[i].wall_time;
+    cpu += phases[i].cpu_time;
+    rss = max(rss, phases[i].peak_rss);
+  }
+  file << "  ]," << endl;
+  file << "  \"total\": { \"wall_time\": " << wall << ", ";
+  file << "\"cpu_time\": " << cpu << ", ";
+  file << "\"peak_rss_kb\": " << rss << " }," << endl;
+  file << "  \"parameters\": {" << endl;
+  for(i = 0; i < parameters.size(); i++) {
+    file << "    \"" << parameters[i].first << "\": " << parameters[i].second;
+    file << (i + 1 < parameters.size() + labels.size() ? "," : "") << endl;
+  }
+  for(i = 0; i < labels.size(); i++) {
+    file << "    \"" << labels[i].first << "\": \"" << labels[i].second << "\"";
+    file << (i + 1 < labels.size() ? "," : "") << endl;
+  }
+  file << "  }" << endl;
+  file << "}" << endl;
+  file.close();
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _HG_PROFILE_H
+#define _HG_PROFILE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "hg_counters.h"
+
+
+/* resources used by one phase of the generation:
+ * wall and cpu (user + system) time in seconds,
+ * peak resident set size (kB) of the process at
+ * the end of the phase, events counted during the
+ * phase (see hg_counters.h) */
+typedef struct struct_hg_profile_phase {
+  std::string name;
+  double wall_time;
+  double cpu_time;
+  long peak_rss;
+  hg_counters_t counters;
+  hg_perf_sample_t perf;
+} hg_profile_phase_t;
+
+
+/* The profiler records the phases of a run and the internal
+ * parameters computed by the library (e.g. the radius found
+ * by hg_get_R and the number of bisection iterations).
+ * When it is not enabled (default) every call returns 
+ * immediately.
+ */
+class HG_Profile {
+private:
+  static bool enabled;
+  static std::vector<hg_profile_phase_t> phases;
+  static std::vector< std::pair<std::string, double> > parameters;
+  static std::vector< std::pair<std::string, std::string> > labels;
+  static hg_profile_phase_t current;
+public:
+  static void enable(const bool & on);
+  static bool is_enabled() { return enabled; }
+  // start and stop a phase, phases cannot be nested
+  static void begin(const std::string & phase);
+  static void end();
+  // record an internal parameter (a new value replaces the old one)
+  static void set(const std::string & name, const double & value);
+  // record a named setting (e.g. the allocation policy)
+  static void set(const std::string & name, const std::string & value);
+  static const std::vector<hg_profile_phase_t> & get_phases() { return phases; }
+  static const std::vector< std::pair<std::string, double> > & get_parameters() { return parameters; }
+  static const std::vector< std::pair<std::string, std::string> > & get_labels() { return labels; }
+  // write phases and parameters in json format
+  static bool write(const std::string & filename);
+};
+
+
+#endif /* _HG_PROFILE_H */
@@ -0,0 +1,276 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+#include "hg_graphs_lib.h"
+#include "hg_utils.h"
+#include "hg_debug.h"
+
+
+/* Polar quadtree: each cell covers [r_min, r_max] x [theta_min, theta_max]
+ * and is split in four children at the middle angle and at the radius that
+ * halves its hyperbolic area (cosh(zeta r) - 1 grows with the area). Nodes
+ * are stored in the leaves, the coordinates of each leaf are contiguous. */
+
+#define HG_QUADTREE_MAX_DEPTH 40
+
+typedef struct struct_hg_quadtree_cell {
+  double r_min, r_max;
+  double theta_min, theta_max;
+  int children[4];     // -1 if missing (leaf if children[0] == -1)
+  unsigned int begin;  // nodes in [begin, end) (leaves only)
+  unsigned int end;
+} hg_quadtree_cell_t;
+
+struct struct_hg_quadtree {
+  const hg_graph_t * graph;
+  hg_graph_type type;
+  double zeta;
+  vector<hg_quadtree_cell_t> cells;
+  vector<unsigned int> ids;
+  vector<hg_coordinate_t> coordinates;
+};
+
+
+static double hg_quadtree_radial_split(const hg_quadtree_t * qt, const double r_min, const double r_max) {
+  double zeta = (qt->type == HYPERBOLIC_RGG || qt->type == HYPERBOLIC_STANDARD) ? qt->zeta : 1.0;
+  double a = cosh(zeta * r_min), b = cosh(zeta * r_max);
+  if(isinf(b)) {
+    return (r_min + r_max) / 2.0;
+  }
+  return acosh((a + b) / 2.0) / zeta;
+}
+
+
+static int hg_quadtree_build_cell(hg_quadtree_t * qt, const double r_min, const double r_max,
+				  const double theta_min, const double theta_max,
+				  const unsigned int begin, const unsigned int end,
+				  const unsigned int leaf_size, const int depth) {
+  int c = qt->cells.size();
+  hg_quadtree_cell_t cell;
+  cell.r_min = r_min;
+  cell.r_max = r_max;
+  cell.theta_min = theta_min;
+  cell.theta_max = theta_max;
+  cell.children[0] = cell.children[1] = cell.children[2] = cell.children[3] = -1;
+  cell.begin = begin;
+  cell.end = end;
+  qt->cells.push_back(cell);
+  if(end - begin <= leaf_size || depth >= HG_QUADTREE_MAX_DEPTH) {
+    return c;
+  }
+  // partition the nodes: first by angle, then each half by radius
+  double theta_mid = (theta_min + theta_max) / 2.0;
+  bool radial = r_max > r_min;
+  double r_mid = radial ? hg_quadtree_radial_split(qt, r_min, r_max) : r_max;
+  vector<unsigned int> order(qt->ids.begin() + begin, qt->ids.begin() + end);
+  unsigned int bounds[5];
+  unsigned int i, q, pos = begin;
+  bounds[0] = begin;
+  for(q = 0; q < 4; q++) {
+    for(i = 0; i < order.size(); i++) {
+      const hg_coordinate_t & x = (*qt->graph)[order[i]];
+      unsigned int quadrant = (x.theta < theta_mid ? 0 : 2) + ((radial && x.r > r_mid) ? 1 : 0);
+      if(quadrant == q) {
+	qt->ids[pos++] = order[i];
+      }
+    }
+    bounds[q+1] = pos;
+  }
+  for(q = 0; q < 4; q++) {
+    if(bounds[q+1] > bounds[q]) {
+      int child = hg_quadtree_build_cell(qt,
+					 (q % 2) ? r_mid : r_min, (q % 2) ? r_max : r_mid,
+					 (q < 2) ? theta_min : theta_mid, (q < 2) ? theta_mid : theta_max,
+					 bounds[q], bounds[q+1], leaf_size, depth + 1);
+      qt->cells[c].children[q] = child;
+    }
+  }
+  return c;
+}
+
+
+hg_quadtree_t * hg_quadtree_build(const hg_graph_t * g, const unsigned int leaf_size) {
+  if(g == NULL) {
+    hg_log_err("Null graph provided.");
+    return NULL;
+  }
+  hg_quadtree_t * qt = new hg_quadtree_t;
+  qt->graph = g;
+  qt->type = (*g)[boost::graph_bundle].type;
+  qt->zeta = (*g)[boost::graph_bundle].zeta_eta;
+  unsigned int n = num_vertices(*g);
+  unsigned int id;
+  double r_max = 0;
+  qt->ids.resize(n);
+  for(id = 0; id < n; id++) {
+    qt->ids[id] = id;
+    r_max = max(r_max, (*g)[id].r);
+  }
+  hg_quadtree_build_cell(qt, 0, r_max, 0, 2 * HG_PI, 0, n, max(leaf_size, 1u), 0);
+  // coordinates in leaf order
+  qt->coordinates.resize(n);
+  for(id = 0; id < n; id++) {
+    qt->coordinates[id] = (*g)[qt->ids[id]];
+  }
+  return qt;
+}
+
+
+void hg_quadtree_free(hg_quadtree_t * qt) {
+  delete qt;
+}
+
+
+/* lower bound of the distance between p and any point of the cell:
+ * the distance grows with the angular distance, so the closest
+ * point has the smallest angle, and for that angle the hyperbolic
+ * distance has a single minimum in r (tanh(zr) = tanh(zr_p) cos(dtheta)) */
+static double hg_quadtree_min_distance(const hg_quadtree_t * qt, const hg_quadtree_cell_t & cell,
+				       const hg_coordinate_t & p) {
+  if(p.theta >= cell.theta_min && p.theta <= cell.theta_max &&
+     p.r >= cell.r_min && p.r <= cell.r_max) {
+    return 0;
+  }
+  double delta_theta = 0;
+  if(p.theta < cell.theta_min || p.theta > cell.theta_max) {
+    double d1 = abs(p.theta - cell.theta_min);
+    double d2 = abs(p.theta - cell.theta_max);
+    delta_theta = min(HG_PI - abs(HG_PI - d1), HG_PI - abs(HG_PI - d2));
+  }
+  switch(qt->type) {
+  case HYPERBOLIC_RGG:
+  case HYPERBOLIC_STANDARD: {
+    double zeta = qt->zeta;
+    double t = tanh(zeta * p.r) * cos(delta_theta);
+    double r = (t > 0) ? atanh(t) / zeta : 0;
+    r = min(max(r, cell.r_min), cell.r_max);
+    double x = cosh(zeta * p.r) * cosh(zeta * r) - sinh(zeta * p.r) * sinh(zeta * r) * cos(delta_theta);
+    return (x <= 1) ? 0 : acosh(x) / zeta;
+  }
+  case SOFT_CONFIGURATION_MODEL:
+    return p.r + cell.r_min;
+  case ANGULAR_RGG:
+  case SOFT_RGG:
+    return delta_theta;
+  default:
+    return 0;
+  }
+}
+
+
+// slack on the bounds, the exact distance is always checked
+#define HG_QUADTREE_EPS 1e-9
+
+
+void hg_quadtree_range(const hg_quadtree_t * qt, const hg_coordinate_t & p, const double d,
+		       vector<unsigned int> & result) {
+  result.clear();
+  if(qt == NULL || qt->cells.empty()) {
+    return;
+  }
+  vector<int> stack(1, 0);
+  while(!stack.empty()) {
+    const hg_quadtree_cell_t & cell = qt->cells[stack.back()];
+    stack.pop_back();
+    if(hg_quadtree_min_distance(qt, cell, p) > d + HG_QUADTREE_EPS * (1 + d)) {
+      continue;
+    }
+    if(cell.children[0] == -1 && cell.children[1] == -1 &&
+       cell.children[2] == -1 && cell.children[3] == -1) {
+      unsigned int i;
+      for(i = cell.begin; i < cell.end; i++) {
+	if(hg_hyperbolic_distance(qt->graph, p, qt->coordinates[i]) <= d) {
+	  result.push_back(qt->ids[i]);
+	}
+      }
+      continue;
+    }
+    int q;
+    for(q = 0; q < 4; q++) {
+      if(cell.children[q] != -1) {
+	stack.push_back(cell.children[q]);
+      }
+    }
+  }
+  sort(result.begin(), result.end());
+}
+
+
+void hg_quadtree_nearest(const hg_quadtree_t * qt, const hg_coordinate_t & p, const unsigned int k,
+			 vector<pair<double, unsigned int> > & result) {
+  result.clear();
+  if(qt == NULL || qt->cells.empty() || k == 0) {
+    return;
+  }
+  // cells to visit (min-heap on the distance bound)
+  typedef pair<double, int> cell_entry_t;
+  priority_queue<cell_entry_t, vector<cell_entry_t>, greater<cell_entry_t> > cells;
+  // k best nodes so far (max-heap on (distance, id))
+  priority_queue<pair<double, unsigned int> > best;
+  cells.push(make_pair(0.0, 0));
+  while(!cells.empty()) {
+    cell_entry_t top = cells.top();
+    cells.pop();
+    if(best.size() == k && top.first > best.top().first + HG_QUADTREE_EPS * (1 + best.top().first)) {
+      break;
+    }
+    const hg_quadtree_cell_t & cell = qt->cells[top.second];
+    bool leaf = true;
+    int q;
+    for(q = 0; q < 4; q++) {
+      if(cell.children[q] != -1) {
+	leaf = false;
+	cells.push(make_pair(hg_quadtree_min_distance(qt, qt->cells[cell.children[q]], p),
+			     cell.children[q]));
+      }
+    }
+    if(!leaf) {
+      continue;
+    }
+    unsigned int i;
+    for(i = cell.begin; i < cell.end; i++) {
+      pair<double, unsigned int> candidate(hg_hyperbolic_distance(qt->graph, p, qt->coordinates[i]),
+					   qt->ids[i]);
+      if(best.size() < k) {
+	best.push(candidate);
+      }
+      else if(candidate < best.top()) {
+	best.pop();
+	best.push(candidate);
+      }
+    }
+  }
+  result.resize(best.size());
+  while(!best.empty()) {
+    result[best.size() - 1] = best.top();
+    best.pop();
+  }
+}
@@ -25,17 +25,24 @@
  */
 
 
+#include <sstream>
+
 #include "hg_random.h"
+#include "hg_counters.h"
 
 /* default seed is 1 */
 HG_RandomGenerator_t HG_Random::random_generator(1);
+unsigned int HG_Random::seed = 1;
+bool HG_Random::pair_mode = false;
 
 void HG_Random::init(const unsigned int & s) {
   HG_RandomGenerator_t generator(s);
   HG_Random::random_generator = generator;
+  HG_Random::seed = s;
 }
 
 double HG_Random::get_random_01_value() {
+  hg_count(HG_COUNTER_RNG_DRAWS);
   // Define a uniform random number distribution which produces "double"
   // values between 0 and 1 (0 inclusive, 1 exclusive).
   boost::uniform_real<> uni_dist(0,1);
@@ -43,3 +50,58 @@ double HG_Random::get_random_01_value() {
   return uni();
 }
 
+
+std::string HG_Random::get_state() {
+  std::ostringstream state;
+  state << HG_Random::random_generator;
+  return state.str();
+}
+
+
+bool HG_Random::set_state(const std::string & state) {
+  // the generator reads past the last number, that must not be
+  // at the end of the stream
+  std::istringstream input(state + " ");
+  HG_RandomGenerator_t generator;
+  input >> generator;
+  if(input.fail()) {
+    return false;
+  }
+  HG_Random::random_generator = generator;
+  return true;
+}
+
+
+
+/* Philox4x32 constants */
+#define HG_PHILOX_M0 0xD2511F53U
+#define HG_PHILOX_M1 0xCD9E8D57U
+#define HG_PHILOX_W0 0x9E3779B9U
+#define HG_PHILOX_W1 0xBB67AE85U
+#define HG_PHILOX_ROUNDS 10
+
+
+double HG_Random::get_pair_random_01_value(const unsigned int & s, const unsigned int & i,
+					   const unsigned int & j) {
+  hg_count(HG_COUNTER_RNG_DRAWS);
+  // counter: (min(i,j), max(i,j), 0, 0), key: (seed, 0)
+  uint32_t x0 = (i < j) ? i : j;
+  uint32_t x1 = (i < j) ? j : i;
+  uint32_t x2 = 0, x3 = 0;
+  uint32_t k0 = s, k1 = 0;
+  int round;
+  for(round = 0; round < HG_PHILOX_ROUNDS; round++) {
+    uint64_t p0 = (uint64_t) HG_PHILOX_M0 * x0;
+    uint64_t p1 = (uint64_t) HG_PHILOX_M1 * x2;
+    uint32_t y0 = (uint32_t) (p1 >> 32) ^ x1 ^ k0;
+    uint32_t y2 = (uint32_t) (p0 >> 32) ^ x3 ^ k1;
+    x1 = (uint32_t) p1;
+    x3 = (uint32_t) p0;
+    x0 = y0;
+    x2 = y2;
+    k0 += HG_PHILOX_W0;
+    k1 += HG_PHILOX_W1;
+  }
+  // 53 random bits (27 from x0, 26 from x1)
+  return ((x0 >> 5) * 67108864.0 + (x1 >> 6)) / 9007199254740992.0;
+}
@@ -33,6 +33,8 @@
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/uniform_real.hpp>
 #include <iostream> 
+#include <string>
+#include <stdint.h>
 
 
 /* "Mersenne Twister: A 623-dimensionally equidistributed uniform pseudo-random
@@ -45,13 +47,34 @@
 typedef boost::mt19937 HG_RandomGenerator_t;
 
 
+/* "Parallel random numbers: as easy as 1, 2, 3", John K. Salmon,
+ * Mark A. Moraes, Ron O. Dror, and David E. Shaw, SC11, 2011.
+ *
+ * Philox4x32-10 is a counter-based generator: the random number of
+ * the pair (i,j) is a function of (seed, i, j) only, hence pairs can
+ * be evaluated in any order (and in parallel). When pair_mode is on
+ * the generators use it to decide on the links, the coordinates are
+ * still extracted from the Mersenne Twister.
+ */
 class HG_Random {
 private:
     static HG_RandomGenerator_t random_generator;
-    static int seed;
+    static unsigned int seed;
+    static bool pair_mode;
 public:
   static void init(const unsigned int & s);
   static double get_random_01_value();
+  /* state of the stream (text), e.g. to resume a generation */
+  static std::string get_state();
+  static bool set_state(const std::string & state);
+  static void set_pair_mode(const bool & on) { pair_mode = on; }
+  static bool is_pair_mode() { return pair_mode; }
+  /* uniform in [0,1) for the pair (i,j), symmetric in i and j */
+  static double get_pair_random_01_value(const unsigned int & s, const unsigned int & i,
+					 const unsigned int & j);
+  static double get_pair_random_01_value(const unsigned int & i, const unsigned int & j) {
+    return get_pair_random_01_value(seed, i, j);
+  }
 };
 
 #endif /* _HG_RANDOM_H */
@@ -0,0 +1,149 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "hg_graphs_lib.h"
+#include "hg_utils.h"
+#include "hg_debug.h"
+
+
+/* the plane (theta, r) is mapped on a grid of 2^16 x 2^16 cells */
+#define HG_HILBERT_BITS 16
+
+
+/* position of the cell (x,y) along the Hilbert curve that 
+ * visits a grid of side 2^bits */
+static uint64_t hg_hilbert_index(uint32_t x, uint32_t y, const int bits) {
+  uint32_t side = (uint32_t) 1 << bits;
+  uint32_t s, rx, ry;
+  uint64_t d = 0;
+  for(s = side / 2; s > 0; s /= 2) {
+    rx = (x & s) > 0;
+    ry = (y & s) > 0;
+    d += (uint64_t) s * s * ((3 * rx) ^ ry);
+    // rotate the quadrant
+    if(ry == 0) {
+      if(rx == 1) {
+	x = side - 1 - x;
+	y = side - 1 - y;
+      }
+      swap(x, y);
+    }
+  }
+  return d;
+}
+
+
+static uint32_t hg_grid_cell(const double value, const double max_value) {
+  uint32_t cells = (uint32_t) 1 << HG_HILBERT_BITS;
+  if(max_value <= 0) {
+    return 0;
+  }
+  double cell = floor(value / max_value * cells);
+  return (uint32_t) max(0.0, min((double) (cells - 1), cell));
+}
+
+
+hg_graph_t * hg_relabel_graph(const hg_graph_t * g, const hg_node_order order,
+			      vector<unsigned int> & permutation) {
+  if(g == NULL) {
+    hg_log_err("Null graph provided.");
+    return NULL;
+  }
+  unsigned int n = num_vertices(*g);
+  unsigned int id;
+  double max_r = 0;
+  for(id = 0; id < n; id++) {
+    max_r = max(max_r, (*g)[id].r);
+  }
+  // permutation[new id] = old id, ties are broken by the old id
+  permutation.resize(n);
+  if(order == HG_ORDER_HILBERT) {
+    vector<pair<uint64_t, unsigned int> > keys(n);
+    for(id = 0; id < n; id++) {
+      uint32_t x = hg_grid_cell((*g)[id].theta, 2 * HG_PI);
+      uint32_t y = hg_grid_cell((*g)[id].r, max_r);
+      keys[id] = make_pair(hg_hilbert_index(x, y, HG_HILBERT_BITS), id);
+    }
+    sort(keys.begin(), keys.end());
+    for(id = 0; id < n; id++) {
+      permutation[id] = keys[id].second;
+    }
+  }
+  else {
+    vector<pair<double, unsigned int> > keys(n);
+    for(id = 0; id < n; id++) {
+      keys[id] = make_pair((*g)[id].theta, id);
+    }
+    sort(keys.begin(), keys.end());
+    for(id = 0; id < n; id++) {
+      permutation[id] = keys[id].second;
+    }
+  }
+  vector<unsigned int> new_id(n);
+  for(id = 0; id < n; id++) {
+    new_id[permutation[id]] = id;
+  }
+  hg_graph_t * relabelled = hg_create_graph(n);
+  (*relabelled)[boost::graph_bundle] = (*g)[boost::graph_bundle];
+  for(id = 0; id < n; id++) {
+    (*relabelled)[id] = (*g)[permutation[id]];
+  }
+  // links are added sorted by new ids, so that they are
+  // also written in an order that follows the coordinates
+  hg_link_buffer_t links;
+  links.reserve(num_edges(*g));
+  hg_graph_t::edge_iterator edgeIt, edgeEnd;
+  boost::tie(edgeIt, edgeEnd) = edges(*g);
+  for (; edgeIt != edgeEnd; ++edgeIt) {
+    unsigned int u = new_id[source(*edgeIt, *g)];
+    unsigned int v = new_id[target(*edgeIt, *g)];
+    links.push_back(make_pair(min(u, v), max(u, v)));
+  }
+  sort(links.begin(), links.end());
+  hg_add_edges(relabelled, links);
+  return relabelled;
+}
+
+
+bool hg_print_permutation(const vector<unsigned int> & permutation, 
+			  const unsigned int starting_id, const string filename) {
+  ofstream file;
+  file.open(filename.c_str(), ios::out);
+  if(file.fail() or !file.is_open()) {
+    hg_log_err("File %s cannot be opened", filename.c_str());
+    return false;
+  }
+  unsigned int id;
+  for(id = 0; id < permutation.size(); id++) {
+    file << id + starting_id << "\t" << permutation[id] + starting_id << "\n";
+  }
+  file.close();
+  return true;
+}
@@ -0,0 +1,266 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+#include <sys/time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "hg_scheduler.h"
+#include "hg_profile.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+/* tasks left to a thread, [begin, end), the owner takes
+ * them from the front and thieves from the back. The 
+ * statistics are written by the owner only, the padding
+ * keeps each worker in its own cache lines */
+typedef struct struct_hg_worker {
+  long begin;
+  long end;
+#ifdef _OPENMP
+  omp_lock_t lock;
+#endif
+  bool working;
+  double task_start;
+  double busy;
+  long tasks;
+  long steals;
+  char padding[64];
+} hg_worker_t;
+
+
+struct struct_hg_scheduler {
+  vector<long> bounds;  // task t is made of items [bounds[t], bounds[t+1])
+  vector<hg_worker_t> workers;
+  bool ordered;
+  double start;
+};
+
+
+static double hg_scheduler_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+static inline void hg_worker_lock(hg_worker_t & w) {
+#ifdef _OPENMP
+  omp_set_lock(&w.lock);
+#endif
+}
+
+
+static inline void hg_worker_unlock(hg_worker_t & w) {
+#ifdef _OPENMP
+  omp_unset_lock(&w.lock);
+#endif
+}
+
+
+hg_scheduler_t * hg_scheduler_new(const vector<double> & costs, const long num_tasks,
+				  const bool ordered) {
+  hg_scheduler_t * s = new hg_scheduler_t;
+  long num_items = costs.size();
+  long i;
+  double total = 0;
+  for(i = 0; i < num_items; i++) {
+    total += costs[i];
+  }
+  /* a task is closed when the cost of the items visited reaches
+   * the next multiple of total / num_tasks (hence rounding errors
+   * do not accumulate), items without a cost are split by count */
+  long tasks = max(1L, min(num_tasks, num_items));
+  double target = (total > 0) ? total / tasks : 0;
+  double cost = 0;
+  vector<double> task_cost;
+  s->bounds.push_back(0);
+  for(i = 0; i < num_items; i++) {
+    cost += (total > 0) ? costs[i] : 1;
+    long closed = s->bounds.size();
+    if(i + 1 == num_items ||
+       (closed < tasks && total > 0 && cost >= target * closed) ||
+       (closed < tasks && total <= 0 && (i + 1) * tasks >= num_items * closed)) {
+      s->bounds.push_back(i + 1);
+      task_cost.push_back(cost);
+    }
+  }
+  tasks = s->bounds.size() - 1;
+  // ranges of tasks having the same total cost
+  int num_threads = 1;
+#ifdef _OPENMP
+  num_threads = omp_get_max_threads();
+#endif
+  s->ordered = ordered;
+  s->workers.resize(num_threads);
+  long t = 0;
+  int w;
+  for(w = 0; w < num_threads; w++) {
+    hg_worker_t & worker = s->workers[w];
+#ifdef _OPENMP
+    omp_init_lock(&worker.lock);
+#endif
+    worker.begin = t;
+    if(ordered) {
+      // a single queue, taken by every thread
+      t = (w == 0) ? tasks : t;
+    }
+    else {
+      for(; t < tasks && (w + 1 == num_threads || 
+			  task_cost[t] * num_threads <= cost * (w + 1)); t++);
+    }
+    worker.end = t;
+    worker.working = false;
+    worker.task_start = 0;
+    worker.busy = 0;
+    worker.tasks = 0;
+    worker.steals = 0;
+  }
+  s->start = hg_scheduler_time();
+  return s;
+}
+
+
+/* the second half of the tasks left to the most loaded thread
+ * is moved to thread w, false if there is nothing to steal */
+static bool hg_scheduler_steal(hg_scheduler_t * s, const int w) {
+  int v, victim;
+  long left, most;
+  do {
+    victim = -1;
+    most = 0;
+    for(v = 0; v < (int) s->workers.size(); v++) {
+      hg_worker_lock(s->workers[v]);
+      left = s->workers[v].end - s->workers[v].begin;
+      hg_worker_unlock(s->workers[v]);
+      if(left > most) {
+	most = left;
+	victim = v;
+      }
+    }
+    if(victim < 0) {
+      return false;
+    }
+    long first = 0;
+    long last = 0;
+    hg_worker_t & thief = s->workers[w];
+    hg_worker_t & other = s->workers[victim];
+    hg_worker_lock(other);
+    left = other.end - other.begin;
+    if(left > 0) {
+      last = other.end;
+      first = other.end - (left + 1) / 2;
+      other.end = first;
+    }
+    hg_worker_unlock(other);
+    if(first < last) {
+      hg_worker_lock(thief);
+      thief.begin = first;
+      thief.end = last;
+      hg_worker_unlock(thief);
+      thief.steals++;
+      return true;
+    }
+    // the victim has taken its last tasks meanwhile
+  } while(true);
+}
+
+
+long hg_scheduler_tasks(const hg_scheduler_t * s) {
+  return s->bounds.size() - 1;
+}
+
+
+bool hg_scheduler_next(hg_scheduler_t * s, long & task, long & first, long & last) {
+  int w = 0;
+#ifdef _OPENMP
+  w = omp_get_thread_num();
+#endif
+  if(w >= (int) s->workers.size()) {
+    // more threads than expected, the others do the work
+    return false;
+  }
+  hg_worker_t & worker = s->workers[w];
+  hg_worker_t & queue = s->ordered ? s->workers[0] : worker;
+  double now = hg_scheduler_time();
+  if(worker.working) {
+    worker.busy += now - worker.task_start;
+    worker.working = false;
+  }
+  task = -1;
+  do {
+    hg_worker_lock(queue);
+    if(queue.begin < queue.end) {
+      task = queue.begin++;
+    }
+    hg_worker_unlock(queue);
+  } while(task < 0 && !s->ordered && hg_scheduler_steal(s, w));
+  if(task < 0) {
+    return false;
+  }
+  first = s->bounds[task];
+  last = s->bounds[task + 1];
+  worker.working = true;
+  worker.task_start = now;
+  worker.tasks++;
+  return true;
+}
+
+
+void hg_scheduler_free(hg_scheduler_t * s, const string & name) {
+  double duration = hg_scheduler_time() - s->start;
+  long tasks = 0;
+  long steals = 0;
+  double busy = 0;
+  double max_busy = 0;
+  unsigned int w;
+  for(w = 0; w < s->workers.size(); w++) {
+    const hg_worker_t & worker = s->workers[w];
+    stringstream key;
+    key << name << "_thread" << w << "_utilisation";
+    HG_Profile::set(key.str(), (duration > 0) ? worker.busy / duration : 0);
+    tasks += worker.tasks;
+    steals += worker.steals;
+    busy += worker.busy;
+    max_busy = max(max_busy, worker.busy);
+#ifdef _OPENMP
+    omp_destroy_lock(&s->workers[w].lock);
+#endif
+  }
+  double mean_busy = busy / s->workers.size();
+  HG_Profile::set(name + "_threads", s->workers.size());
+  HG_Profile::set(name + "_tasks", tasks);
+  HG_Profile::set(name + "_steals", steals);
+  // slowest thread with respect to the average one
+  HG_Profile::set(name + "_imbalance", (mean_busy > 0) ? max_busy / mean_busy : 1);
+  hg_debug("\t%s: %ld tasks, %ld steals, %u threads busy %f s on average (%f s)",
+	   name.c_str(), tasks, steals, (unsigned int) s->workers.size(), mean_busy, duration);
+  delete s;
+}
@@ -0,0 +1,79 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HG_SCHEDULER_H
+#define _HG_SCHEDULER_H
+
+#include <string>
+#include <vector>
+
+
+/* Cost based scheduling of the parallel loops (link creation by pair,
+ * node properties). The items of a loop (e.g. rows of the pair loop)
+ * are grouped into contiguous tasks having about the same estimated
+ * cost, tasks are split among the threads (contiguous ranges of the
+ * same total cost) and a thread whose range is over steals the second
+ * half of the range of the most loaded thread. In ordered mode every
+ * thread takes the first task left, hence tasks start in order (as 
+ * with schedule(dynamic, 1)), which is required when the results are
+ * released in order (pipeline, checkpoints).
+ *
+ * Usage:
+ *   hg_scheduler_t * s = hg_scheduler_new(costs, num_tasks, false);
+ *   #pragma omp parallel
+ *   {
+ *     long task, first, last;
+ *     while(hg_scheduler_next(s, task, first, last)) {
+ *       // items [first, last)
+ *     }
+ *   }
+ *   hg_scheduler_free(s, "links");
+ *
+ * The parallel region must not have more threads than 
+ * omp_get_max_threads() when the scheduler is created.
+ */
+typedef struct struct_hg_scheduler hg_scheduler_t;
+
+/* costs[i] is the estimated cost of item i (>= 0), at most num_tasks
+ * tasks are created */
+hg_scheduler_t * hg_scheduler_new(const std::vector<double> & costs, const long num_tasks,
+				  const bool ordered);
+
+/* number of tasks created */
+long hg_scheduler_tasks(const hg_scheduler_t * s);
+
+/* next task of the calling thread: task index (tasks are numbered in
+ * the order of their items) and items [first, last), false when no
+ * task is left (the thread must not call it again) */
+bool hg_scheduler_next(hg_scheduler_t * s, long & task, long & first, long & last);
+
+/* the statistics of the loop (busy time of each thread with respect
+ * to the duration of the loop, tasks, steals) are added to the profile
+ * as <name>_<statistic>, then the scheduler is destroyed */
+void hg_scheduler_free(hg_scheduler_t * s, const std::string & name);
+
+
+#endif /* _HG_SCHEDULER_H */
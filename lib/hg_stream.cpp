@@ -0,0 +1,236 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "hg_graphs_lib.h"
+#include "hg_utils.h"
+#include "hg_debug.h"
+
+
+/* buffered reader: the .hg file is read in large blocks
+ * and numbers are parsed directly from the buffer, links
+ * are the bulk of the file and they are just pairs of
+ * unsigned integers */
+#define HG_STREAM_BUFFER_SIZE (1 << 20)
+
+struct struct_hg_stream {
+  istream * file;
+  vector<char> buffer;
+  size_t pos;
+  size_t len;
+  unsigned int starting_id;
+  unsigned int coordinates_left;
+  // .hgc files: node whose neighbours are read
+  hg_compressed_t * compressed;
+  unsigned int num_nodes;
+  long node;
+  vector<unsigned int> neighbours;
+  size_t next;
+};
+
+
+static inline int hg_stream_getc(hg_stream_t * s) {
+  if(s->pos == s->len) {
+    s->file->read(&s->buffer[0], s->buffer.size());
+    s->len = s->file->gcount();
+    s->pos = 0;
+    if(s->len == 0) {
+      return EOF;
+    }
+  }
+  return (unsigned char) s->buffer[s->pos++];
+}
+
+
+static inline int hg_stream_skip_spaces(hg_stream_t * s) {
+  int c;
+  do {
+    c = hg_stream_getc(s);
+  } while(c == ' ' || c == '\t' || c == '\n' || c == '\r');
+  return c;
+}
+
+
+static bool hg_stream_token(hg_stream_t * s, string & token) {
+  int c = hg_stream_skip_spaces(s);
+  token.clear();
+  while(c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+    token += (char) c;
+    c = hg_stream_getc(s);
+  }
+  return !token.empty();
+}
+
+
+static inline bool hg_stream_uint(hg_stream_t * s, unsigned int & value) {
+  int c = hg_stream_skip_spaces(s);
+  if(c < '0' || c > '9') {
+    return false;
+  }
+  value = 0;
+  while(c >= '0' && c <= '9') {
+    value = value * 10 + (c - '0');
+    c = hg_stream_getc(s);
+  }
+  return true;
+}
+
+
+hg_stream_t * hg_stream_open(const string filename, hg_parameters_t & par) {
+  if(hg_has_extension(filename, ".hgc")) {
+    hg_compressed_t * c = hg_compressed_open(filename, par);
+    if(c == NULL) {
+      return NULL;
+    }
+    par.type = hg_infer_hg_type(par.expected_gamma, par.temperature);
+    hg_stream_t * s = new hg_stream_t;
+    s->file = NULL;
+    s->compressed = c;
+    s->starting_id = 0;
+    s->coordinates_left = par.expected_n;
+    s->num_nodes = par.expected_n;
+    s->node = -1;
+    s->next = 0;
+    return s;
+  }
+  // decompressed on the fly if .gz
+  istream * file = hg_open_input_file(filename);
+  if(file == NULL) {
+    return NULL;
+  }
+  hg_stream_t * s = new hg_stream_t;
+  s->file = file;
+  s->compressed = NULL;
+  s->buffer.resize(HG_STREAM_BUFFER_SIZE);
+  s->pos = 0;
+  s->len = 0;
+  // reading first line: <name> <value> pairs
+  string name, value;
+  int i;
+  for(i = 0; i < 7; i++) {
+    if(!hg_stream_token(s, name) || !hg_stream_token(s, value)) {
+      hg_log_err("File %s: wrong header", filename.c_str());
+      hg_stream_close(s);
+      return NULL;
+    }
+    switch(i) {
+    case 0: par.expected_n = atoi(value.c_str()); break;
+    case 1: par.temperature = atof(value.c_str()); break;
+    case 2: par.expected_gamma = atof(value.c_str()); break;
+    case 3: par.expected_degree = atof(value.c_str()); break;
+    case 4: par.zeta_eta = atof(value.c_str()); break;
+    case 5: par.seed = atoi(value.c_str()); break;
+    case 6: par.starting_id = strtoul(value.c_str(), NULL, 10); break;
+    }
+  }
+  par.type = hg_infer_hg_type(par.expected_gamma, par.temperature);
+  s->starting_id = par.starting_id;
+  s->coordinates_left = par.expected_n;
+  return s;
+}
+
+
+bool hg_stream_read_coordinate(hg_stream_t * s, unsigned int & id,
+			       hg_coordinate_t & c) {
+  if(s->compressed != NULL) {
+    if(s->coordinates_left == 0) {
+      return false;
+    }
+    id = s->num_nodes - s->coordinates_left--;
+    return hg_compressed_coordinate(s->compressed, id, c);
+  }
+  string radial, angular;
+  if(s->coordinates_left == 0 || !hg_stream_uint(s, id) ||
+     !hg_stream_token(s, radial) || !hg_stream_token(s, angular)) {
+    return false;
+  }
+  s->coordinates_left--;
+  id -= s->starting_id;
+  c.r = strtod(radial.c_str(), NULL);
+  c.theta = strtod(angular.c_str(), NULL);
+  return true;
+}
+
+
+/* links of a .hgc file: each link is read once, from its lower
+ * id endpoint, sorted by (node1, node2) as hg_read_compressed_graph
+ * loads them */
+static bool hg_stream_compressed_link(hg_stream_t * s, unsigned int & node1,
+				      unsigned int & node2) {
+  s->coordinates_left = 0;
+  while(true) {
+    while(s->next < s->neighbours.size()) {
+      node2 = s->neighbours[s->next++];
+      if((long) node2 > s->node) {
+	node1 = s->node;
+	return true;
+      }
+    }
+    if(s->node + 1 >= (long) s->num_nodes) {
+      return false;
+    }
+    s->node++;
+    s->next = 0;
+    if(!hg_compressed_neighbours(s->compressed, s->node, s->neighbours)) {
+      hg_log_err("Wrong adjacency of node %ld", s->node);
+      return false;
+    }
+  }
+}
+
+
+bool hg_stream_read_link(hg_stream_t * s, unsigned int & node1,
+			 unsigned int & node2) {
+  if(s->compressed != NULL) {
+    return hg_stream_compressed_link(s, node1, node2);
+  }
+  unsigned int id;
+  hg_coordinate_t c;
+  while(s->coordinates_left > 0) {
+    if(!hg_stream_read_coordinate(s, id, c)) {
+      return false;
+    }
+  }
+  if(!hg_stream_uint(s, node1) || !hg_stream_uint(s, node2)) {
+    return false;
+  }
+  node1 -= s->starting_id;
+  node2 -= s->starting_id;
+  return true;
+}
+
+
+void hg_stream_close(hg_stream_t * s) {
+  if(s == NULL) {
+    return;
+  }
+  delete s->file;
+  hg_compressed_close(s->compressed);
+  delete s;
+}
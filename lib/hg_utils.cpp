@@ -27,6 +27,8 @@
 #include "hg_utils.h"
 #include "hg_random.h"
 #include "hg_debug.h"
+#include <algorithm>
+#include <climits>
 
 
 hg_graph_type hg_infer_hg_type(const double & expected_gamma, const double & temperature) {
@@ -80,6 +82,117 @@ hg_coordinate_t hg_get_coordinate(const hg_graph_t * graph, const int id) {
 }
 
 
+hg_arena_t * hg_graph_arena(const hg_graph_t * g) {
+#ifdef HG_BOOST_EDGE_LIST
+  return g->m_edges.get_allocator().arena;
+#else
+  // the edge list is not accessible: the nodes added
+  // later go in the default arena of the thread
+  return hg_arena_default();
+#endif
+}
+
+
+void hg_add_edges(hg_graph_t * g, const hg_link_buffer_t & links) {
+  size_t n = num_vertices(*g);
+  size_t m = links.size();
+  size_t k;
+  // links having an id out of [0, n) are skipped
+  vector<bool> keep(m, true);
+  size_t invalid = 0;
+  for(k = 0; k < m; k++) {
+    if(links[k].first < 0 || (size_t) links[k].first >= n ||
+       links[k].second < 0 || (size_t) links[k].second >= n) {
+      keep[k] = false;
+      invalid++;
+    }
+  }
+  if(invalid > 0) {
+    hg_log_err("%lu links have a node id out of [0, %lu), skipped",
+	       (unsigned long) invalid, (unsigned long) n);
+  }
+#ifdef HG_BOOST_EDGE_LIST
+  if(m > UINT_MAX) {
+#endif
+    // link positions do not fit the buckets below
+    // (or boost does not expose the edge list)
+    for(k = 0; k < m; k++) {
+      if(keep[k]) {
+	add_edge(links[k].first, links[k].second, *g);
+      }
+    }
+#ifdef HG_BOOST_EDGE_LIST
+    return;
+  }
+  /* boost::adjacency_list (vec_adj_list_impl) stores each undirected
+   * link once in m_edges and, in both out-edge sets, a StoredEdge
+   * that points to it: this is what add_edge does, see
+   * boost/graph/detail/adjacency_list.hpp (configure checks that
+   * these members are available) */
+  typedef hg_graph_t::StoredEdge hg_stored_edge_t;
+  typedef hg_graph_t::EdgeContainer hg_edge_list_t;
+  size_t i, v;
+  // both endpoints of each link, bucketed by node (counting sort):
+  // (other endpoint, position of the link in the buffer)
+  vector<size_t> offsets(n + 1, 0);
+  for(k = 0; k < m; k++) {
+    if(!keep[k]) {
+      continue;
+    }
+    offsets[links[k].first + 1]++;
+    if(links[k].second != links[k].first) {
+      offsets[links[k].second + 1]++;
+    }
+  }
+  for(v = 0; v < n; v++) {
+    offsets[v + 1] += offsets[v];
+  }
+  vector<pair<unsigned int, unsigned int> > half(offsets[n]);
+  vector<size_t> pos(offsets.begin(), offsets.end() - 1);
+  for(k = 0; k < m; k++) {
+    if(!keep[k]) {
+      continue;
+    }
+    half[pos[links[k].first]++] = make_pair(links[k].second, k);
+    if(links[k].second != links[k].first) {
+      half[pos[links[k].second]++] = make_pair(links[k].first, k);
+    }
+  }
+  vector<size_t>().swap(pos);
+  // sorted neighbours, the later copies of a link are dropped
+  for(v = 0; v < n; v++) {
+    sort(half.begin() + offsets[v], half.begin() + offsets[v + 1]);
+    bool linked = !g->out_edge_list(v).empty();
+    for(i = offsets[v]; i < offsets[v + 1]; i++) {
+      if((i > offsets[v] && half[i].first == half[i - 1].first) ||
+	 (linked && edge(v, half[i].first, *g).second)) {
+	keep[half[i].second] = false;
+      }
+    }
+  }
+  // the edge list follows the buffer order
+  vector<hg_edge_list_t::iterator> edge_it(m);
+  for(k = 0; k < m; k++) {
+    if(keep[k]) {
+      g->m_edges.push_back(hg_edge_list_t::value_type(links[k].first, links[k].second));
+      edge_it[k] = --g->m_edges.end();
+    }
+  }
+  // new neighbours are larger than the ones already in
+  // the set in most cases (e.g. hg_graph_grow)
+  for(v = 0; v < n; v++) {
+    for(i = offsets[v]; i < offsets[v + 1]; i++) {
+      if(keep[half[i].second]) {
+	g->out_edge_list(v).insert(g->out_edge_list(v).end(),
+				   hg_stored_edge_t(half[i].first, edge_it[half[i].second],
+						    &g->m_edges));
+      }
+    }
+  }
+#endif
+}
+
+
 /* How to extract from any probability distribution:
  * The probability integral transform states that if X is
  * a continuous random variable with cumulative distribution
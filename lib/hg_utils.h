@@ -42,6 +42,24 @@ hg_coordinate_t hg_get_coordinate(const hg_graph_t * graph, const int id);
 
 
 
+//  ============= graph construction utilities  ============= 
+
+/* arena of the out-edge sets and of the edge list of a graph
+ * built by hg_create_graph, the nodes added within an
+ * hg_arena_scope of this arena go in it as well */
+hg_arena_t * hg_graph_arena(const hg_graph_t * g);
+
+/* add the links of the buffer to g, the same as calling add_edge
+ * on each link (edges(g) lists the new links in the buffer order,
+ * duplicates, links already in g and links having an id out of
+ * [0, num_vertices) are skipped) without a lookup
+ * per link: each neighbour set is filled in id order with end
+ * hinted inserts, which take amortized constant time
+ */
+void hg_add_edges(hg_graph_t * g, const hg_link_buffer_t & links);
+
+
+
 //  ============= coordinates' random extraction utilities  ============= 
 
 /* extract a radial coordinate value uniformly from an 
@@ -64,4 +82,28 @@ double hg_uniform_angular_coordinate();
 
 
 
+//  ============= file utilities  ============= 
+
+// true if filename ends with extension
+bool hg_has_extension(const string & filename, const string extension);
+
+/* open a file for reading or writing, files having the
+ * .gz extension are compressed (decompressed) on the fly
+ * in blocks processed in parallel (see hg_gzip.cpp), NULL
+ * if the file cannot be opened
+ */
+istream * hg_open_input_file(const string filename);
+ostream * hg_open_output_file(const string filename);
+
+/* complete the writing and delete the stream, false
+ * if any write failed */
+bool hg_close_output_file(ostream * file);
+
+/* write the first line (the parameters) of g, and the 
+ * coordinates of its nodes from first_id on, in .hg format */
+void hg_print_header(ostream & file, const hg_graph_t *g);
+void hg_print_coordinates(ostream & file, const hg_graph_t *g, const unsigned int first_id);
+
+
+
 #endif /* _HG_UTILS_H */
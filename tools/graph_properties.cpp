@@ -35,10 +35,10 @@
 #include <unistd.h>
 
 #include "hg_graphs_lib.h"
+#include "hg_profile.h"
 #include "hg_debug.h"
 #include "stats.h"
-
-#include <boost/graph/clustering_coefficient.hpp>
+#include "properties.h"
 
 // accumulators
 #include <boost/accumulators/accumulators.hpp>
@@ -68,6 +68,23 @@ void usage (string exe_name){
   cout << "\t" << "\t" << "default value is ./graph.hg" << endl;
   cout << "\t" << "-o" << "\t" << "output folder" << endl;
   cout << "\t" << "\t" << "default value is current folder" << endl;
+  cout << "\t" << "-s" << "\t" << "streaming mode: the graph is not loaded in memory, the" << endl;
+  cout << "\t" << "\t" << "graph file is read twice and links are stored in" << endl;
+  cout << "\t" << "\t" << "temporary files in the output folder" << endl;
+  cout << "\t" << "-m" << "\t" << "memory (MB) used for links in streaming mode" << endl;
+  cout << "\t" << "\t" << "default value is 1024" << endl;
+  cout << "\t" << "-a" << "\t" << "approximate clustering: wedges are sampled until the 95%" << endl;
+  cout << "\t" << "\t" << "confidence interval of each degree class is narrower" << endl;
+  cout << "\t" << "\t" << "than the error provided (e.g. 0.01), classes having" << endl;
+  cout << "\t" << "\t" << "few wedges (and small graphs) are computed exactly;" << endl;
+  cout << "\t" << "\t" << "cc.txt is not written and cc_k.txt has a third column" << endl;
+  cout << "\t" << "\t" << "with the confidence interval half width" << endl;
+  cout << "\t" << "-b" << "\t" << "time budget (seconds) for the approximate clustering" << endl;
+  cout << "\t" << "\t" << "(the error is 0.01 unless -a is provided)" << endl;
+  cout << "\t" << "-p" << "\t" << "profile: write the wall/cpu time of each phase and the" << endl;
+  cout << "\t" << "\t" << "utilisation of each thread in the parallel loops in" << endl;
+  cout << "\t" << "\t" << "profile.json (output folder)" << endl;
+  cout << "\t" << "-A" << "\t" << "allocation policy of the large arrays (see hyperbolic_graph_generator)" << endl;
   cout << "\t" << "-h" << "\t" << "print help menu" << endl; 
   cout << endl;
   cout << "OUTPUT:" << endl;
@@ -84,6 +101,17 @@ void usage (string exe_name){
   cout << "\t" << "cc.txt" << endl;
   cout << "\t" << "\t\t" << "<node id> <node clustering coefficient>" << endl;
   cout << endl;
+  cout << "\t" << "and four text files describing the degree classes:" << endl;
+  cout << endl;
+  cout << "\t" << "degree_pdf.txt" << endl;
+  cout << "\t" << "\t\t" << "<degree k> <fraction of nodes having degree k>" << endl;
+  cout << "\t" << "degree_ccdf.txt" << endl;
+  cout << "\t" << "\t\t" << "<degree k> <fraction of nodes having degree greater than k>" << endl;
+  cout << "\t" << "knn_k.txt" << endl;
+  cout << "\t" << "\t\t" << "<degree k> <avg. neigh. degree of nodes having degree k>" << endl;
+  cout << "\t" << "cc_k.txt" << endl;
+  cout << "\t" << "\t\t" << "<degree k> <avg. clustering coefficient of nodes having degree k>" << endl;
+  cout << endl;
   return;
 }
 
@@ -98,11 +126,19 @@ int main (int argc, char **argv) {
   int index;
   int c;  
   bool verbose = true;
+  bool streaming = false;
+  size_t memory = 1024; // MB
+  bool approximate = false;
+  double cc_error = 0.01;
+  double time_budget = 0; // seconds
+  bool profile = false;
+  hg_placement placement = HG_PLACEMENT_DEFAULT;
+  hg_page_size pages = HG_PAGES_DEFAULT;
   opterr = 0;
 
   hg_debug("parsing options");
  
-  while ((c = getopt (argc, argv, "i:o:qh")) != -1) {
+  while ((c = getopt (argc, argv, "i:o:sm:a:b:A:pqh")) != -1) {
     switch (c) {
     case 'i':
       graph_file = optarg;
@@ -110,6 +146,29 @@ int main (int argc, char **argv) {
     case 'o':
       output_folder = optarg;
       break;
+    case 's':
+      streaming = true;
+      break;
+    case 'm':
+      memory = strtoul(optarg, NULL, 10);
+      break;
+    case 'a':
+      approximate = true;
+      cc_error = atof(optarg);
+      break;
+    case 'b':
+      approximate = true;
+      time_budget = atof(optarg);
+      break;
+    case 'p':
+      profile = true;
+      break;
+    case 'A':
+      if(!hg_parse_allocation(optarg, placement, pages)) {
+	hg_enduser_warning("Allocation policy must be a list of first-touch, interleave, thp, hugetlb. \n\t  Quitting.");
+	return 1;
+      }
+      break;
     case 'h':
       usage(argv[0]);
       return 0;
@@ -127,79 +186,112 @@ int main (int argc, char **argv) {
     }
   }
 
-  hg_debug("reading hg graph");
-  if(verbose) {
-    cout << "Loading graph " << graph_file << endl;
-  }
-  hg_graph_t *graph = NULL;
-  graph = hg_read_graph(graph_file);
-  if(graph == NULL) {
-    hg_enduser_warning("Empty topology - %s \n\t  Quitting.", graph_file.c_str());
+  if(approximate && cc_error <= 0) {
+    hg_enduser_warning("The clustering error must be positive. \n\t  Quitting.");
     return 1;
   }
-  if(verbose) {
-    cout << "Graph loaded" << endl;
+  if(approximate && streaming) {
+    hg_enduser_warning("Approximate clustering is not available in streaming mode. \n\t  The exact clustering will be computed.");
+    approximate = false;
   }
 
   stringstream s;
   s << "mkdir -p " << output_folder;
   system(s.str().c_str());
+  HG_Profile::enable(profile);
+  hg_set_allocation(placement, pages);
 
-  int n = num_vertices(*graph);
-  double k, knn, cc;
-  double r, theta;
+  int n;
+  int id;
+  unsigned int starting_id;
 
-  // maps
-  map<int,double> degree_map;
-  map<int,double> avg_neigh_degree;
-  map<int,double> clust_coeff;
-  map<int,double> radial;
-  map<int,double> angular;
+  // per-node properties (indexed by node id)
+  node_properties_t np;
+  vector<double> radial;
+  vector<double> angular;
+  degree_classes_t dc;
+  clustering_estimate_t ce;
   
   // accumulators
   boost::accumulators::accumulator_set<double, boost::accumulators::stats<  boost::accumulators::tag::mean, boost::accumulators::tag::moment<2> > > ks;
   boost::accumulators::accumulator_set<double, boost::accumulators::stats<  boost::accumulators::tag::mean, boost::accumulators::tag::moment<2> > > knns;
   boost::accumulators::accumulator_set<double, boost::accumulators::stats<  boost::accumulators::tag::mean, boost::accumulators::tag::moment<2> > > ccs;
 
-  // properties computation
-  hg_debug("computing properties");
-
-  if(verbose) {
-    cout << "Graph properties computation" << endl;
+  if(streaming) {
+    // the graph is never loaded in memory
+    hg_debug("streaming hg graph");
+    if(verbose) {
+      cout << "Graph properties computation (streaming " << graph_file << ")" << endl;
+    }
+    hg_parameters_t par;
+    HG_Profile::begin("stream_node_properties");
+    bool ok = stream_node_properties(graph_file, output_folder, memory * 1024 * 1024,
+				     par, radial, angular, np);
+    HG_Profile::end();
+    if(!ok) {
+      hg_enduser_warning("Unable to compute properties - %s \n\t  Quitting.", graph_file.c_str());
+      return 1;
+    }
+    n = par.expected_n;
+    starting_id = par.starting_id;
   }
+  else {
+    hg_debug("reading hg graph");
+    if(verbose) {
+      cout << "Loading graph " << graph_file << endl;
+    }
+    hg_graph_t *graph = NULL;
+    HG_Profile::begin("hg_read_graph");
+    graph = hg_read_graph(graph_file);
+    HG_Profile::end();
+    if(graph == NULL) {
+      hg_enduser_warning("Empty topology - %s \n\t  Quitting.", graph_file.c_str());
+      return 1;
+    }
+    if(verbose) {
+      cout << "Graph loaded" << endl;
+    }
 
+    // properties computation
+    hg_debug("computing properties");
+    if(verbose) {
+      cout << "Graph properties computation" << endl;
+    }
 
-  unsigned int starting_id = (*graph)[boost::graph_bundle].starting_id;
-  
-  hg_graph_t::vertex_iterator vertexIt, vertexEnd;
-  hg_graph_t::adjacency_iterator neighbourIt, neighbourEnd;
-  boost::tie(vertexIt, vertexEnd) = vertices(*graph);
-  for (; vertexIt != vertexEnd; ++vertexIt) { 
-    // degree
-    k =  degree(*vertexIt,*graph);
-    if(k == 0) continue; // we do not consider 0-degree nodes
-    // knn
-    knn = 0;
-    boost::tie(neighbourIt, neighbourEnd) = adjacent_vertices(*vertexIt, *graph); 
-    for (; neighbourIt != neighbourEnd; ++neighbourIt){ 
-      knn += degree(*neighbourIt,*graph);
+    n = num_vertices(*graph);
+    starting_id = (*graph)[boost::graph_bundle].starting_id;
+    HG_Profile::begin("node_properties");
+    hg_csr_t *csr = hg_get_csr(graph);
+    node_properties(*csr, np, !approximate);
+    HG_Profile::end();
+    if(approximate) {
+      HG_Profile::begin("approximate_clustering");
+      approximate_clustering(*csr, np.degree, cc_error, time_budget, 1, ce);
+      HG_Profile::end();
     }
-    if(k!=0){
-      knn = knn /k;
+    delete csr;
+    radial.resize(n);
+    angular.resize(n);
+    for(id = 0; id < n; id++) {
+      radial[id] = (*graph)[id].r;
+      angular[id] = (*graph)[id].theta;
     }
-    // clustering coefficient 
-    cc = clustering_coefficient(*graph,*vertexIt);
-    // putting data in maps and accumulators
-    degree_map.insert(make_pair(*vertexIt + starting_id,k));
-    avg_neigh_degree.insert(make_pair(*vertexIt + starting_id,knn));
-    clust_coeff.insert(make_pair(*vertexIt + starting_id,cc));
-    ks(k);
-    knns(knn);
-    ccs(cc);
-    // radial and angular coordinates
-    radial.insert(make_pair(*vertexIt + starting_id, (*graph)[*vertexIt].r));
-    angular.insert(make_pair(*vertexIt + starting_id, (*graph)[*vertexIt].theta));
-    hg_debug("%lu: k %f \t knn %f \t cc %f \t (%f,%f)", *vertexIt, k, knn, cc, (*graph)[*vertexIt].r, (*graph)[*vertexIt].theta);
+    // destroy graph
+    delete graph;
+  }
+
+  for(id = 0; id < n; id++) {
+    if(np.degree[id] == 0) continue; // we do not consider 0-degree nodes
+    ks(np.degree[id]);
+    knns(np.knn[id]);
+    if(approximate) {
+      add_node(dc, np.degree[id], np.knn[id], 0);
+      hg_debug("%d: k %u \t knn %f \t (%f,%f)", id, np.degree[id], np.knn[id], radial[id], angular[id]);
+      continue;
+    }
+    ccs(np.cc[id]);
+    add_node(dc, np.degree[id], np.knn[id], np.cc[id]);
+    hg_debug("%d: k %u \t knn %f \t cc %f \t (%f,%f)", id, np.degree[id], np.knn[id], np.cc[id], radial[id], angular[id]);
   }
 
   if(verbose) {
@@ -208,18 +300,48 @@ int main (int argc, char **argv) {
 
   // printing all the id - value maps
   hg_debug("printing properties in %s", output_folder.c_str());
-  print(output_folder + "/degree.txt", degree_map);
-  print(output_folder + "/knn.txt", avg_neigh_degree);
-  print(output_folder + "/cc.txt", clust_coeff);
-  print(output_folder + "/radial.txt", radial);
-  print(output_folder + "/angular.txt", angular);
+  print(output_folder + "/degree.txt", np.degree, np.degree, starting_id);
+  print(output_folder + "/knn.txt", np.knn, np.degree, starting_id);
+  if(!approximate) {
+    print(output_folder + "/cc.txt", np.cc, np.degree, starting_id);
+  }
+  print(output_folder + "/radial.txt", radial, np.degree, starting_id);
+  print(output_folder + "/angular.txt", angular, np.degree, starting_id);
+  print(output_folder + "/degree_pdf.txt", pdf(dc.count));
+  print(output_folder + "/degree_ccdf.txt", ccdf(dc.count));
+  print(output_folder + "/knn_k.txt", avg_over_degree(dc.count, dc.knn));
+  if(approximate) {
+    distribution_t cc_k;
+    size_t k;
+    for(k = 1; k < dc.count.size(); k++) {
+      if(dc.count[k] == 0) continue;
+      cc_k.push_back(make_pair((double) k, ce.cc_k[k]));
+    }
+    print(output_folder + "/cc_k.txt", cc_k, ce.cc_k_error);
+  }
+  else {
+    print(output_folder + "/cc_k.txt", avg_over_degree(dc.count, dc.cc));
+  }
+  if(profile) {
+    hg_allocation_profile();
+    HG_Profile::write(output_folder + "/profile.json");
+  }
   if(verbose) {
     cout << "Files written in " << output_folder << ":" << endl;
     cout << "\t" << "degree.txt "<< endl;
     cout << "\t" << "knn.txt"<< endl;
-    cout << "\t" << "cc.txt"<< endl;
+    if(!approximate) {
+      cout << "\t" << "cc.txt"<< endl;
+    }
     cout << "\t" << "radial.txt"<< endl;
     cout << "\t" << "angular.txt"<< endl;
+    cout << "\t" << "degree_pdf.txt"<< endl;
+    cout << "\t" << "degree_ccdf.txt"<< endl;
+    cout << "\t" << "knn_k.txt"<< endl;
+    cout << "\t" << "cc_k.txt"<< endl;
+    if(profile) {
+      cout << "\t" << "profile.json"<< endl;
+    }
     cout << endl;
     cout << "Average values (std deviation): " << endl;
     cout.setf( std::ios::fixed, std:: ios::floatfield ); // floatfield set to fixed
@@ -228,13 +350,19 @@ int main (int argc, char **argv) {
     cout<< " (" << sqrt(boost::accumulators::moment<2>(ks)) << ")"<< endl;
     cout << "\t" << "knn:\t\t" << boost::accumulators::mean(knns);
     cout << " (" << sqrt(boost::accumulators::moment<2>(knns)) << ")"<< endl;
-    cout << "\t" << "clustering:\t" << boost::accumulators::mean(ccs);
-    cout << " (" << sqrt(boost::accumulators::moment<2>(ccs)) << ")"<< endl;
+    if(approximate) {
+      cout << endl;
+      cout << "Clustering " << (ce.exact ? "(exact)" : "(95% confidence interval)") << ": " << endl;
+      cout << "\t" << "clustering:\t" << ce.avg_cc << " (+/- " << ce.avg_cc_error << ")" << endl;
+      cout << "\t" << "transitivity:\t" << ce.transitivity << " (+/- " << ce.transitivity_error << ")" << endl;
+      cout << "\t" << "wedges sampled:\t" << ce.samples << endl;
+    }
+    else {
+      cout << "\t" << "clustering:\t" << boost::accumulators::mean(ccs);
+      cout << " (" << sqrt(boost::accumulators::moment<2>(ccs)) << ")"<< endl;
+    }
     cout << endl;
   }
-  
-  // destroy graph
-  delete graph;
 
 
   return 0;
@@ -40,6 +40,7 @@
 #include <boost/graph/connected_components.hpp>
 
 #include "hg_graphs_lib.h"
+#include "hg_counters.h"
 #include "hg_debug.h"
 
 using namespace std;
@@ -67,6 +68,14 @@ void usage (string exe_name){
   cout << "\t" << "\t" << "default value is 10000" << endl;
   cout << "\t" << "-s" << "\t" << "random seed" << endl;
   cout << "\t" << "\t" << "default value is 1" << endl;
+  cout << "\t" << "-x" << "\t" << "implicit graph: the links in the input file (if any) are not read," << endl;
+  cout << "\t" << "\t" << "they are computed from the coordinates when needed" << endl;
+  cout << "\t" << "\t" << "(hyperbolic and angular random geometric graphs only)" << endl;
+  cout << "\t" << "-c" << "\t" << "compact mode: links are stored with 32-bit ids (CSR) and the graph" << endl;
+  cout << "\t" << "\t" << "is not built, distances are computed on float coordinates (next" << endl;
+  cout << "\t" << "\t" << "hops close to the shortest distance are re-checked in double" << endl;
+  cout << "\t" << "\t" << "precision), implicit links as well: same success ratio for all" << endl;
+  cout << "\t" << "\t" << "the models" << endl;
   cout << "\t" << "-h" << "\t" << "print help menu" << endl; 
   cout << endl;
   cout << "OUTPUT:" << endl;
@@ -90,6 +99,201 @@ string print_path(vector<int> path) {
 #endif
 
 
+/* connected components of an implicit graph (breadth first
+ * visit), returns the number of components */
+int implicit_connected_components(const hg_implicit_graph_t * implicit, vector<int> & component) {
+  int n = num_vertices(*hg_implicit_graph_coordinates(implicit));
+  int num = 0;
+  int id;
+  unsigned int i;
+  vector<unsigned int> queue, neighbours;
+  component.assign(n, -1);
+  for(id = 0; id < n; id++) {
+    if(component[id] != -1) {
+      continue;
+    }
+    component[id] = num;
+    queue.assign(1, id);
+    while(!queue.empty()) {
+      int current = queue.back();
+      queue.pop_back();
+      hg_implicit_graph_neighbours(implicit, current, neighbours);
+      for(i = 0; i < neighbours.size(); i++) {
+	if(component[neighbours[i]] == -1) {
+	  component[neighbours[i]] = num;
+	  queue.push_back(neighbours[i]);
+	}
+      }
+    }
+    num++;
+  }
+  return num;
+}
+
+
+/* connected components of a CSR adjacency (breadth first
+ * visit), returns the number of components */
+int csr_connected_components(const hg_csr_t * csr, vector<int> & component) {
+  int n = csr->offsets.size() - 1;
+  int num = 0;
+  int id;
+  size_t i;
+  vector<unsigned int> queue;
+  component.assign(n, -1);
+  for(id = 0; id < n; id++) {
+    if(component[id] != -1) {
+      continue;
+    }
+    component[id] = num;
+    queue.assign(1, id);
+    while(!queue.empty()) {
+      int current = queue.back();
+      queue.pop_back();
+      for(i = csr->offsets[current]; i < csr->offsets[current+1]; i++) {
+	if(component[csr->neighbours[i]] == -1) {
+	  component[csr->neighbours[i]] = num;
+	  queue.push_back(csr->neighbours[i]);
+	}
+      }
+    }
+    num++;
+  }
+  return num;
+}
+
+
+/* coordinates of a graph in compact mode: float copies, read
+ * for every neighbour, and the double ones, read for the 
+ * neighbours close to the shortest distance only */
+struct compact_coordinates {
+  hg_coordinate_array_t coordinates;
+  vector<float> r;
+  vector<float> theta;
+};
+
+
+/* parameters (in the bundle of a graph without nodes) and
+ * coordinates of a graph file, the links are not read */
+hg_graph_t * read_compact_coordinates(const string & graph_file, compact_coordinates & cc) {
+  hg_parameters_t par;
+  hg_stream_t * s = hg_stream_open(graph_file, par);
+  if(s == NULL) {
+    return NULL;
+  }
+  cc.coordinates.resize(par.expected_n);
+  cc.r.resize(par.expected_n);
+  cc.theta.resize(par.expected_n);
+  unsigned int id;
+  hg_coordinate_t c;
+  int read = 0;
+  while(hg_stream_read_coordinate(s, id, c)) {
+    if(id >= cc.coordinates.size()) {
+      break;
+    }
+    cc.coordinates[id] = c;
+    cc.r[id] = c.r;
+    cc.theta[id] = c.theta;
+    read++;
+  }
+  hg_stream_close(s);
+  if(read != par.expected_n) {
+    hg_log_err("File %s: wrong coordinates", graph_file.c_str());
+    return NULL;
+  }
+  hg_graph_t * graph = hg_create_graph(0);
+  (*graph)[boost::graph_bundle] = par;
+  return graph;
+}
+
+
+/* distances computed on float coordinates differ from the
+ * exact ones by less than this (relative) margin */
+#define COMPACT_TOLERANCE 1e-4
+
+
+/* next hop candidates in compact mode: distances from dst are
+ * computed on the float coordinates, and only the neighbours
+ * whose distance is within the margin from the shortest one
+ * are evaluated again on the double coordinates, hence the
+ * candidates are the same as in the default mode.
+ * The distance drops to 0 when the coordinates are the same as
+ * the ones of dst (e.g. from r1+r2 in the soft configuration
+ * model, or 1 in the Erdos-Renyi model), the margin does not
+ * hold across this jump: dst is recognised by id, and the
+ * neighbours whose float coordinates are the same as the ones
+ * of dst are evaluated on the double coordinates right away */
+void compact_candidates(const hg_graph_t * graph, const compact_coordinates & cc,
+			const vector<unsigned int> & neighbours, const int dst,
+			const hg_coordinate_t & dst_coo, vector<double> & distances,
+			vector<int> & candidates) {
+  hg_coordinate_t dst_f, cur_f;
+  dst_f.r = cc.r[dst];
+  dst_f.theta = cc.theta[dst];
+  double min_distance = -1.0;
+  unsigned int n_index;
+  distances.resize(neighbours.size());
+  for (n_index = 0; n_index < neighbours.size(); n_index++){ 
+    hg_count(HG_COUNTER_NEIGHBOUR_SCANS);
+    if(neighbours[n_index] == (unsigned int) dst) {
+      distances[n_index] = 0;
+    }
+    else if(cc.r[neighbours[n_index]] == cc.r[dst] && 
+	    cc.theta[neighbours[n_index]] == cc.theta[dst]) {
+      hg_count(HG_COUNTER_RECHECKS);
+      distances[n_index] = hg_hyperbolic_distance(graph, cc.coordinates[neighbours[n_index]], dst_coo);
+    }
+    else {
+      cur_f.r = cc.r[neighbours[n_index]];
+      cur_f.theta = cc.theta[neighbours[n_index]];
+      distances[n_index] = hg_hyperbolic_distance(graph, cur_f, dst_f);
+    }
+    if(min_distance == -1 or min_distance > distances[n_index]) {
+      min_distance = distances[n_index];
+    }
+  }
+  double threshold = min_distance + COMPACT_TOLERANCE * (1 + min_distance);
+  double candidate_distance = -1.0;
+  candidates.clear();
+  for (n_index = 0; n_index < neighbours.size(); n_index++){ 
+    if(distances[n_index] > threshold) {
+      continue;
+    }
+    hg_count(HG_COUNTER_RECHECKS);
+    double distance = hg_hyperbolic_distance(graph, cc.coordinates[neighbours[n_index]], dst_coo);
+    if(candidate_distance == -1 or candidate_distance > distance) {
+      candidate_distance = distance;
+      candidates.clear();
+      candidates.push_back(neighbours[n_index]);
+    }
+    else if(candidate_distance == distance) {
+      candidates.push_back(neighbours[n_index]);
+    }
+  }
+}
+
+
+/* neighbours of id sorted by id (i.e. in the order of the
+ * adjacency of an explicit graph) */
+void get_neighbours(const hg_graph_t * graph, const hg_implicit_graph_t * implicit,
+		    const hg_csr_t * csr, const int id, vector<unsigned int> & neighbours) {
+  if(implicit != NULL) {
+    hg_implicit_graph_neighbours(implicit, id, neighbours);
+    return;
+  }
+  if(csr != NULL) {
+    neighbours.assign(csr->neighbours.begin() + csr->offsets[id],
+		      csr->neighbours.begin() + csr->offsets[id+1]);
+    return;
+  }
+  neighbours.clear();
+  hg_graph_t::adjacency_iterator neighbourIt, neighbourEnd;
+  tie(neighbourIt, neighbourEnd) = adjacent_vertices(id, *graph); 
+  for (; neighbourIt != neighbourEnd; ++neighbourIt){ 
+    neighbours.push_back(*neighbourIt);
+  }
+}
+
+
 
 int main (int argc, char **argv) {
 
@@ -97,6 +301,8 @@ int main (int argc, char **argv) {
   string graph_file = "./graph.hg";
   int seed = 1;
   int num_attempts = 10000;
+  bool implicit_links = false;
+  bool compact = false;
 
   hg_debug("parsing options");
 
@@ -105,7 +311,7 @@ int main (int argc, char **argv) {
   int c;  
   opterr = 0;
  
-  while ((c = getopt (argc, argv, "i:a:s:h")) != -1) {
+  while ((c = getopt (argc, argv, "i:a:s:xch")) != -1) {
     switch (c) {
     case 'i':
       graph_file = optarg;
@@ -116,6 +322,12 @@ int main (int argc, char **argv) {
     case 's':
      seed = atoi(optarg);
       break;
+    case 'x':
+      implicit_links = true;
+      break;
+    case 'c':
+      compact = true;
+      break;
     case 'h':
       usage(argv[0]);
      return 0;
@@ -131,30 +343,70 @@ int main (int argc, char **argv) {
   }
 
   hg_debug("reading hg graph");
-  hg_graph_t *graph = NULL;
-  graph = hg_read_graph(graph_file);
+  const hg_graph_t *graph = NULL;
+  hg_graph_t *explicit_graph = NULL;
+  hg_implicit_graph_t *implicit = NULL;
+  hg_csr_t *csr = NULL;
+  compact_coordinates cc;
+  hg_set_compact(compact);
+  if(implicit_links) {
+    implicit = hg_read_implicit_graph(graph_file);
+    if(implicit != NULL) {
+      graph = hg_implicit_graph_coordinates(implicit);
+    }
+  }
+  else if(compact) {
+    // the graph has no nodes, the coordinates are in cc
+    // and the links are stored in the CSR
+    explicit_graph = read_compact_coordinates(graph_file, cc);
+    if(explicit_graph != NULL) {
+      csr = hg_read_csr(graph_file);
+    }
+    if(csr == NULL) {
+      delete explicit_graph;
+      explicit_graph = NULL;
+    }
+    graph = explicit_graph;
+  }
+  else {
+    explicit_graph = hg_read_graph(graph_file);
+    graph = explicit_graph;
+  }
   if(graph == NULL) {
     hg_enduser_warning("Empty topology - %s \n\t  Quitting.", graph_file.c_str());
     return 1;
   }
 
   // computing the connected components of this graph
-  std::vector<int> component(num_vertices(*graph));
-  int num = connected_components(*graph, &component[0]);
+  std::vector<int> component((*graph)[boost::graph_bundle].expected_n);
+  int num;
+  if(implicit != NULL) {
+    num = implicit_connected_components(implicit, component);
+  }
+  else if(csr != NULL) {
+    num = csr_connected_components(csr, component);
+  }
+  else {
+    num = connected_components(*explicit_graph, &component[0]);
+  }
   std::vector<int>::size_type i;
   hg_debug("Total number of components: %d", num);
     
   hg_init_random_generator(seed);
 
-  hg_graph_t::adjacency_iterator neighbourIt, neighbourEnd;
+  vector<unsigned int> neighbours;
+  unsigned int n_index;
   double distance = -1.0;
-  vector<int> empty;
-  // candidate_next map:
-  // distance: list_of_nodes_at_same distance
-  pair<double,vector<int> > candidate_next = make_pair(distance,empty);
+  // candidates: nodes at the same (minimum) distance from dst
+  double candidate_distance;
+  vector<int> candidates;
+  vector<double> distances;
   hg_coordinate_t cur_coo;
   hg_coordinate_t dst_coo;
   int candidate_index;
+  // the visited nodes of an attempt are released in bulk when it ends
+  hg_arena_t * attempt_arena = hg_arena_new();
+  hg_arena_allocator<int> attempt_allocator(attempt_arena);
 
   int effective_attempts = 0;
   int success = 0;
@@ -163,19 +415,25 @@ int main (int argc, char **argv) {
     int src = floor(hg_rand_01_wrapper() *((*graph)[boost::graph_bundle].expected_n - 1.0));
     int dst = floor(hg_rand_01_wrapper() *((*graph)[boost::graph_bundle].expected_n - 1.0));
     // we do not consider isolated nodes
-    if( degree(src,*graph) == 0 or degree(dst,*graph)==0) {
-      continue;
-    }
     // we do not consider nodes in different components
     if(component[src] != component[dst]) {
       continue;
     }
+    get_neighbours(graph, implicit, csr, src, neighbours);
+    if(neighbours.empty()) {
+      continue;
+    }
     effective_attempts++;
-    dst_coo.r = (*graph)[dst].r;
-    dst_coo.theta = (*graph)[dst].theta;
+    if(csr != NULL) {
+      dst_coo = cc.coordinates[dst];
+    }
+    else {
+      dst_coo.r = (*graph)[dst].r;
+      dst_coo.theta = (*graph)[dst].theta;
+    }
     hg_debug("\tAttempt %d: %d -> %d", effective_attempts, src, dst);
     // greedy routing @ work
-    set<int> visited; // visited nodes
+    set<int, less<int>, hg_arena_allocator<int> > visited(less<int>(), attempt_allocator); // visited nodes
 #ifdef DEBUG_ON
     vector<int> path; // nodes path (src - dst)
 #endif
@@ -187,32 +445,40 @@ int main (int argc, char **argv) {
       path.push_back(current);
 #endif
       // select next current node (i.e. closest to destination)
-      candidate_next = make_pair(-1.0,empty);
-      tie(neighbourIt, neighbourEnd) = adjacent_vertices(current, *graph); 
-      int k = 0;
-      for (; neighbourIt != neighbourEnd; ++neighbourIt){ 
-	k++;
-	cur_coo.r = (*graph)[*neighbourIt].r;
-	cur_coo.theta = (*graph)[*neighbourIt].theta;
+      candidate_distance = -1.0;
+      candidates.clear();
+      get_neighbours(graph, implicit, csr, current, neighbours);
+#ifdef DEBUG_ON
+      int k = neighbours.size();
+#endif
+      if(csr != NULL) {
+	compact_candidates(graph, cc, neighbours, dst, dst_coo, distances, candidates);
+      }
+      for (n_index = 0; csr == NULL && n_index < neighbours.size(); n_index++){ 
+	hg_count(HG_COUNTER_NEIGHBOUR_SCANS);
+	cur_coo.r = (*graph)[neighbours[n_index]].r;
+	cur_coo.theta = (*graph)[neighbours[n_index]].theta;
 	distance = hg_hyperbolic_distance(graph, cur_coo, dst_coo);
-	// hg_debug("\t\t\tNeighbor %lu @ %f", *neighbourIt, distance);
-	if(candidate_next.first == -1 or candidate_next.first > distance) {
-	  candidate_next = make_pair(distance,empty);
-	  candidate_next.second.push_back(*neighbourIt);
+	// hg_debug("\t\t\tNeighbor %u @ %f", neighbours[n_index], distance);
+	if(candidate_distance == -1 or candidate_distance > distance) {
+	  candidate_distance = distance;
+	  candidates.clear();
+	  candidates.push_back(neighbours[n_index]);
 	}
 	else {
-	  if(candidate_next.first == distance) {
-	    candidate_next.second.push_back(*neighbourIt);
+	  if(candidate_distance == distance) {
+	    candidates.push_back(neighbours[n_index]);
 	  }
 	}	
       }
       // now we have a vector of candidates equally distant from the dst
       // we extract a random one (this node has at least one neighbor)
-      candidate_index = floor(hg_rand_01_wrapper() *(candidate_next.second.size()-1));
-      current = candidate_next.second[candidate_index];
+      candidate_index = floor(hg_rand_01_wrapper() *(candidates.size()-1));
+      current = candidates[candidate_index];
+      hg_count(HG_COUNTER_ROUTING_HOPS);
 #ifdef DEBUG_ON
-      hg_debug("\t\t Distance: %f, k: %d, nodes: %lu, choosen: %d ", candidate_next.first, k,
-	    candidate_next.second.size(), current);
+      hg_debug("\t\t Distance: %f, k: %d, nodes: %lu, choosen: %d ", candidate_distance, k,
+	    candidates.size(), current);
 #endif
       // if the current node has been already visited then we register a fail
       if(visited.find(current) != visited.end()){
@@ -242,7 +508,12 @@ int main (int argc, char **argv) {
   else {
     hg_enduser_warning("0 effective attempts");
   }
-  delete graph;
+  hg_arena_free(attempt_arena);
+  if(implicit != NULL) {
+    hg_implicit_graph_free(implicit);
+  }
+  delete csr;
+  delete explicit_graph;
 
   return 0;
 }
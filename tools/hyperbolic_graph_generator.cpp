@@ -30,9 +30,11 @@
 #include <stdlib.h>
 #include <cstdlib>
 #include <unistd.h>
+#include <getopt.h>
 #include <sstream>
 
 #include "hg_graphs_lib.h"
+#include "hg_profile.h"
 #include "hg_debug.h"
 
      
@@ -75,6 +77,48 @@ void usage (string exe_name){
   cout << "\t" << "\t" << "default value is current folder" << endl;
   cout << "\t" << "-f" << "\t" << "graph file name" << endl; 
   cout << "\t" << "\t" << "default value is graph (.hg extension is always added)" << endl;
+  cout << "\t" << "-e" << "\t" << "existing graph (.hg, .hg.gz or .hgc file) to extend: -d new nodes are added using" << endl;
+  cout << "\t" << "\t" << "its parameters (-n, -k, -g, -t, -z are ignored), only the pairs" << endl;
+  cout << "\t" << "\t" << "involving a new node are evaluated and the existing links are copied" << endl;
+  cout << "\t" << "\t" << "default seed is the seed of the existing graph plus its size" << endl;
+  cout << "\t" << "-d" << "\t" << "number of nodes to add to the existing graph" << endl;
+  cout << "\t" << "\t" << "default value is 100" << endl;
+  cout << "\t" << "-p" << "\t" << "profile (--profile): write wall/cpu time and peak memory of each" << endl;
+  cout << "\t" << "\t" << "phase, as well as the internal parameters, in <graph file name>.profile.json" << endl;
+  cout << "\t" << "-r" << "\t" << "pair random numbers (--pair-rng): the random number that decides on" << endl;
+  cout << "\t" << "\t" << "each pair of nodes is a function of the seed and of the two nodes, hence" << endl;
+  cout << "\t" << "\t" << "links are generated in parallel (the graph differs from the default one)" << endl;
+  cout << "\t" << "-S" << "\t" << "shard (--shard i/N): generate the shard i (0 <= i < N) of the graph, i.e." << endl;
+  cout << "\t" << "\t" << "all the coordinates and the links whose lower id node has angular coordinate" << endl;
+  cout << "\t" << "\t" << "in [2 pi i/N, 2 pi (i+1)/N), in <graph file name>.shard<i>of<N>.hg; pair random" << endl;
+  cout << "\t" << "\t" << "numbers (-r) are used, the shards are merged by merge_shards" << endl;
+  cout << "\t" << "-L" << "\t" << "relabel (--relabel angle|hilbert): node ids follow the angular coordinate" << endl;
+  cout << "\t" << "\t" << "(angle) or a Hilbert curve in (theta, r) (hilbert), so that nodes close in the" << endl;
+  cout << "\t" << "\t" << "space have close ids; the original id of each node is written in" << endl;
+  cout << "\t" << "\t" << "<graph file name>.perm (one <new id> <original id> line per node)" << endl;
+  cout << "\t" << "-x" << "\t" << "implicit graph (--implicit): only the coordinates are written, the links" << endl;
+  cout << "\t" << "\t" << "are a function of the coordinates and they are not generated (hyperbolic" << endl;
+  cout << "\t" << "\t" << "and angular random geometric graphs only, i.e. t = 0, see greedy_routing -x)" << endl;
+  cout << "\t" << "-c" << "\t" << "gzip (--gzip): the graph file is compressed (.hg.gz extension), blocks" << endl;
+  cout << "\t" << "\t" << "are compressed in parallel; all the tools read .hg.gz files" << endl;
+  cout << "\t" << "-w" << "\t" << "pipeline (--pipeline): links are written by an I/O thread while they are" << endl;
+  cout << "\t" << "\t" << "generated, and they are never stored in memory (same file, it cannot be" << endl;
+  cout << "\t" << "\t" << "combined with -e, -L or -x)" << endl;
+  cout << "\t" << "-C" << "\t" << "checkpoint (--checkpoint seconds): the progress of the link creation is" << endl;
+  cout << "\t" << "\t" << "saved periodically in <graph file name>.ckpt(.links), the files are removed" << endl;
+  cout << "\t" << "\t" << "once all the links are created (it cannot be combined with -e, -w or -x)" << endl;
+  cout << "\t" << "-R" << "\t" << "resume (--resume): continue an interrupted generation from its last" << endl;
+  cout << "\t" << "\t" << "checkpoint (same parameters, the graph is the same an uninterrupted run" << endl;
+  cout << "\t" << "\t" << "produces), checkpoints go on every 600 seconds unless -C is provided" << endl;
+  cout << "\t" << "-m" << "\t" << "compact (--compact): hyperbolic and angular random geometric graphs" << endl;
+  cout << "\t" << "\t" << "decide the pairs on float coordinates and re-check in double precision" << endl;
+  cout << "\t" << "\t" << "the pairs close to the threshold (same graph, half the memory read per" << endl;
+  cout << "\t" << "\t" << "pair; the graph keeps its double coordinates, the memory used is not reduced)" << endl;
+  cout << "\t" << "-A" << "\t" << "allocation (--alloc policy): placement and pages of the large arrays," << endl;
+  cout << "\t" << "\t" << "comma separated: first-touch or interleave (NUMA nodes), thp or" << endl;
+  cout << "\t" << "\t" << "hugetlb (huge pages); the profile reports the policy used" << endl;
+  cout << "\t" << "\t" << "(first-touch splits each array in equal parts among the threads, the" << endl;
+  cout << "\t" << "\t" << "dynamic loops that use it do not follow this split: placement is approximate)" << endl;
   cout << "\t" << "-h" << "\t" << "print help menu" << endl; 
   cout << "\t" << "-q" << "\t" << "quiet (no information print on standard output)" << endl;
   cout << endl;
@@ -96,6 +140,130 @@ void usage (string exe_name){
 }
 
 
+/* add delta nodes to the graph in grow_file and write the
+ * result in folder + filename + graph_ext */
+int grow_graph(const string & grow_file, const int delta, int seed, const bool seed_provided,
+	       const string & folder, const string & filename, const string & graph_ext,
+	       const bool profile, const bool verbose) {
+  if(delta < 1) {
+    hg_enduser_warning("Number of new nodes must be d>=1. \n\t  Quitting.");   
+    return 1;
+  }
+  string out_file = folder + filename + graph_ext;
+  char * in_path = realpath(grow_file.c_str(), NULL);
+  char * out_path = realpath(out_file.c_str(), NULL);
+  bool same_file = (in_path != NULL && out_path != NULL && string(in_path) == string(out_path));
+  free(in_path);
+  free(out_path);
+  if(same_file) {
+    hg_enduser_warning("The extended graph cannot overwrite %s. \n\t  Quitting.", grow_file.c_str());
+    return 1;
+  }
+  HG_Profile::enable(profile);
+  // the existing links are not loaded, they are copied from the file
+  hg_graph_t *graph = hg_read_graph(grow_file, false);
+  if(graph == NULL) {
+    hg_enduser_warning("Empty topology - %s \n\t  Quitting.", grow_file.c_str());
+    return 1;
+  }
+  int old_n = num_vertices(*graph);
+  if(!seed_provided) {
+    seed = (*graph)[boost::graph_bundle].seed + old_n;
+  }
+  if(seed < 1){
+    hg_enduser_warning("Seed has to be greater than 0. \n\t  Assuming seed = 1.");
+    seed = 1;
+  }
+  if(verbose) {
+    cout << endl;
+    cout << "Parameters:" << endl;
+    cout << "\t" << "Existing graph [e]:" << "\t\t\t" << grow_file << endl;
+    cout << "\t" << "New nodes [d]:" << "\t\t\t\t" << delta << endl;
+    cout << "\t" << "Seed [s]:" << "\t\t\t\t" << seed << endl;
+    cout << "\t" << "Output file [o,f]:"<< "\t\t\t"  << out_file << endl;
+    cout << endl;
+  }
+  hg_graph_grow(graph, delta, seed, verbose);
+  if(verbose) {
+    cout << "Generated: " << "\t" << num_edges(*graph) << " new links" << endl;
+  }
+  HG_Profile::begin("hg_print_graph");
+  bool written = hg_print_grown_graph(graph, old_n, grow_file, out_file);
+  HG_Profile::end();
+  if(written && verbose) {
+    cout << "Written: " << "\t" << out_file << endl;
+    cout << endl;
+  }
+  if(profile) {
+    HG_Profile::write(folder + filename + ".profile.json");
+  }
+  delete graph;
+  return written ? 0 : 1;
+}
+
+
+/* generate a graph and write it in folder + filename + graph_ext
+ * while its links are created (see hg_graph_generator_to_file) */
+int generate_pipelined_graph(const int n, const double k_bar, const double exp_gamma,
+			     const double t, const double zeta_eta, const int seed,
+			     const string & folder, const string & filename, const string & graph_ext,
+			     const bool sharded, const bool profile, const bool verbose) {
+  string out_file = folder + filename + graph_ext;
+  long links = hg_graph_generator_to_file(n, k_bar, exp_gamma, t, zeta_eta, seed, out_file, verbose);
+  if(links < 0) {
+    hg_enduser_warning("No graph generated.");
+    return 1;
+  }
+  int ret = 0;
+  // a shard may have no links
+  if(links == 0 && !sharded) {
+    hg_enduser_warning("All nodes have zero degree (no edges in the graph)");
+    ret = 1;
+  }
+  if(verbose) {
+    cout << "Generated: " << "\t" << links << " links" << endl;
+    cout << "Written: " << "\t" << out_file << endl;
+    cout << endl;
+  }
+  if(profile) {
+    HG_Profile::write(folder + filename + ".profile.json");
+    if(verbose) {
+      cout << "Profile: " << "\t" << folder << filename << ".profile.json" << endl;
+      cout << endl;
+    }
+  }
+  return ret;
+}
+
+
+/* generate the coordinates of a threshold model and write them 
+ * (with no links) in folder + filename + graph_ext */
+int generate_implicit_graph(const int n, const double k_bar, const double exp_gamma,
+			    const double t, const double zeta_eta, const int seed,
+			    const string & folder, const string & filename, const string & graph_ext,
+			    const bool profile, const bool verbose) {
+  string out_file = folder + filename + graph_ext;
+  hg_implicit_graph_t *implicit = hg_implicit_graph_generator(n, k_bar, exp_gamma, t, 
+							      zeta_eta, seed, verbose);
+  if(implicit == NULL) {
+    hg_enduser_warning("No graph generated (implicit graphs require t = 0).");
+    return 1;
+  }
+  HG_Profile::begin("hg_print_graph");
+  hg_print_graph(hg_implicit_graph_coordinates(implicit), out_file);
+  HG_Profile::end();
+  if(verbose) {
+    cout << "Written: " << "\t" << out_file << " (coordinates only)" << endl;
+    cout << endl;
+  }
+  if(profile) {
+    HG_Profile::write(folder + filename + ".profile.json");
+  }
+  hg_implicit_graph_free(implicit);
+  return 0;
+}
+
+
 int main (int argc, char **argv) {
 
   /* HG Graph Generator: default parameters */
@@ -108,8 +276,24 @@ int main (int argc, char **argv) {
   int seed = 1;         // random seed
   string folder = ".";
   string graph_filename = "graph";
-  const string graph_ext = ".hg";
+  string graph_ext = ".hg";
+  const string profile_ext = ".profile.json";
   bool verbose = true; 
+  bool profile = false;
+  string grow_file = "";  // existing graph to extend
+  int delta = 100;        // number of nodes to add
+  bool seed_provided = false;
+  bool implicit_links = false;
+  bool pipelined = false;
+  double checkpoint_interval = 0;  // seconds between checkpoints (0 = none)
+  bool resume = false;
+  bool compact = false;
+  hg_placement placement = HG_PLACEMENT_DEFAULT;
+  hg_page_size pages = HG_PAGES_DEFAULT;
+  int shard = 0;          // shard to generate
+  int num_shards = 1;     // number of shards
+  bool relabel = false;
+  hg_node_order order = HG_ORDER_ANGLE;
 
   char *cvalue = NULL;
   int index;
@@ -118,8 +302,23 @@ int main (int argc, char **argv) {
   hg_debug("parsing option start");
 
   opterr = 0;
+
+  static struct option long_options[] = {
+    {"profile", no_argument, 0, 'p'},
+    {"implicit", no_argument, 0, 'x'},
+    {"pair-rng", no_argument, 0, 'r'},
+    {"shard", required_argument, 0, 'S'},
+    {"relabel", required_argument, 0, 'L'},
+    {"gzip", no_argument, 0, 'c'},
+    {"pipeline", no_argument, 0, 'w'},
+    {"checkpoint", required_argument, 0, 'C'},
+    {"resume", no_argument, 0, 'R'},
+    {"compact", no_argument, 0, 'm'},
+    {"alloc", required_argument, 0, 'A'},
+    {0, 0, 0, 0}
+  };
  
-  while ((c = getopt (argc, argv, "n:k:g:t:z:s:o:f:hq")) != -1) {
+  while ((c = getopt_long (argc, argv, "n:k:g:t:z:s:o:f:e:d:prS:L:C:A:Rxcwmhq", long_options, NULL)) != -1) {
     switch (c) {
     case 'n':
       n = atoi(optarg);
@@ -139,6 +338,13 @@ int main (int argc, char **argv) {
       break;
     case 's':
       seed = atoi(optarg);
+      seed_provided = true;
+      break;
+    case 'e':
+      grow_file = optarg;
+      break;
+    case 'd':
+      delta = atoi(optarg);
       break;
     case 'o':
       folder = optarg;
@@ -146,6 +352,57 @@ int main (int argc, char **argv) {
     case 'f':
       graph_filename = optarg;
       break;
+    case 'p':
+      profile = true;
+      break;
+    case 'r':
+      hg_use_pair_random_generator(true);
+      break;
+    case 'S':
+      if(sscanf(optarg, "%d/%d", &shard, &num_shards) != 2 || 
+	 num_shards < 1 || shard < 0 || shard >= num_shards) {
+	hg_enduser_warning("Shard must be i/N with 0 <= i < N. \n\t  Quitting.");
+	return 1;
+      }
+      break;
+    case 'L':
+      relabel = true;
+      if(string(optarg) == "hilbert") {
+	order = HG_ORDER_HILBERT;
+      }
+      else if(string(optarg) != "angle") {
+	hg_enduser_warning("Relabelling order must be angle or hilbert. \n\t  Quitting.");
+	return 1;
+      }
+      break;
+    case 'x':
+      implicit_links = true;
+      break;
+    case 'c':
+      graph_ext = ".hg.gz";
+      break;
+    case 'w':
+      pipelined = true;
+      break;
+    case 'C':
+      checkpoint_interval = atof(optarg);
+      if(checkpoint_interval <= 0) {
+	hg_enduser_warning("Checkpoint interval must be greater than 0 seconds. \n\t  Quitting.");
+	return 1;
+      }
+      break;
+    case 'R':
+      resume = true;
+      break;
+    case 'm':
+      compact = true;
+      break;
+    case 'A':
+      if(!hg_parse_allocation(optarg, placement, pages)) {
+	hg_enduser_warning("Allocation policy must be a list of first-touch, interleave, thp, hugetlb. \n\t  Quitting.");
+	return 1;
+      }
+      break;
     case 'q':
       verbose = false;
       break;
@@ -168,6 +425,40 @@ int main (int argc, char **argv) {
   stringstream s;
   s << "mkdir -p " << folder;
   system((s.str()).c_str());
+
+  if(relabel && (!grow_file.empty() || implicit_links || num_shards > 1)) {
+    hg_enduser_warning("Relabelling cannot be combined with -e, -S or -x. \n\t  Quitting.");
+    return 1;
+  }
+
+  if((checkpoint_interval > 0 || resume) && (!grow_file.empty() || implicit_links || pipelined)) {
+    hg_enduser_warning("Checkpoints cannot be combined with -e, -w or -x. \n\t  Quitting.");
+    return 1;
+  }
+
+  if(pipelined && (!grow_file.empty() || implicit_links || relabel)) {
+    hg_enduser_warning("The pipeline cannot be combined with -e, -L or -x. \n\t  Quitting.");
+    return 1;
+  }
+
+  if(num_shards > 1) {
+    if(!grow_file.empty() || implicit_links) {
+      hg_enduser_warning("Shards cannot be combined with -e or -x. \n\t  Quitting.");
+      return 1;
+    }
+    stringstream shard_name;
+    shard_name << graph_filename << ".shard" << shard << "of" << num_shards;
+    graph_filename = shard_name.str();
+    hg_set_shard(shard, num_shards);
+  }
+
+  hg_set_compact(compact);
+  hg_set_allocation(placement, pages);
+
+  if(!grow_file.empty()) {
+    return grow_graph(grow_file, delta, seed, seed_provided, folder, 
+		      graph_filename, graph_ext, profile, verbose);
+  }
   
   //Limit cases that we do not take into account
   if(n < 3){
@@ -244,11 +535,33 @@ int main (int argc, char **argv) {
     cout << "\t" << "Graph file name [f]:"<< "\t\t\t"  << graph_filename << graph_ext;
     if(graph_filename == "graph") { cout << "   (default)";}
     cout << endl;
+    if(num_shards > 1) {
+      cout << "\t" << "Shard [S]:"<< "\t\t\t\t"  << shard << "/" << num_shards << endl;
+    }
     cout << endl;
   }
 
   hg_debug("generating graph");
 
+  HG_Profile::enable(profile);
+
+  if(implicit_links) {
+    return generate_implicit_graph(n, k_bar, exp_gamma, t, zeta_eta, seed, folder, 
+				   graph_filename, graph_ext, profile, verbose);
+  }
+
+  if(pipelined) {
+    return generate_pipelined_graph(n, k_bar, exp_gamma, t, zeta_eta, seed, folder,
+				    graph_filename, graph_ext, num_shards > 1, profile, verbose);
+  }
+
+  if(checkpoint_interval > 0 || resume) {
+    if(checkpoint_interval <= 0) {
+      checkpoint_interval = 600;
+    }
+    hg_set_checkpoint(folder + graph_filename + ".ckpt", checkpoint_interval, resume);
+  }
+
   hg_graph_t *graph = hg_graph_generator(n, k_bar, exp_gamma, t, zeta_eta, seed, verbose);
 
   hg_debug("printing graph");
@@ -260,7 +573,8 @@ int main (int argc, char **argv) {
 
   int ret = 0;
   // if the number of edges is 0, then no graph has been constructed
-  if(num_edges(*graph) == 0) {
+  // (a shard may have no links)
+  if(num_edges(*graph) == 0 && num_shards == 1) {
     hg_enduser_warning( "All nodes have zero degree (no edges in the graph)");
     ret = 1;
   }
@@ -268,13 +582,38 @@ int main (int argc, char **argv) {
     if(verbose) {
       cout << "Generated: " << "\t" << num_edges(*graph) << " links" << endl;
     }
+    if(relabel) {
+      HG_Profile::begin("relabel");
+      vector<unsigned int> permutation;
+      hg_graph_t *relabelled = hg_relabel_graph(graph, order, permutation);
+      delete graph;
+      graph = relabelled;
+      string perm_file = folder + graph_filename + ".perm";
+      if(!hg_print_permutation(permutation, (*graph)[boost::graph_bundle].starting_id, perm_file)) {
+	ret = 1;
+      }
+      HG_Profile::end();
+      if(verbose) {
+	cout << "Written: " << "\t" << perm_file << endl;
+      }
+    }
+    HG_Profile::begin("hg_print_graph");
     hg_print_graph(graph, folder + graph_filename + graph_ext);
+    HG_Profile::end();
     if(verbose) {
       cout << "Written: " << "\t" << folder << graph_filename << graph_ext << endl;
       cout << endl;
     }
   }
 
+  if(profile) {
+    HG_Profile::write(folder + graph_filename + profile_ext);
+    if(verbose) {
+      cout << "Profile: " << "\t" << folder << graph_filename << profile_ext << endl;
+      cout << endl;
+    }
+  }
+
   // deallocating memory for hg_graph
   delete graph;
 
@@ -0,0 +1,121 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hg_graphs_lib.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+void usage (string exe_name){
+  cout << "NAME: " << endl;
+  cout << "\t" << "merge_shards" << " -- merge the shards of a hyperbolic graph " << endl;
+  cout << endl;
+  cout << "SYNOPSIS: " << endl;
+  cout << "\t" << "merge_shards" << " [parameters] <shard files> " << endl;
+  cout << endl;
+  cout << "DESCRIPTION:" << endl;
+  cout << "\t" << "The program merges the shards of a graph generated by" << endl;
+  cout << "\t" << "hyperbolic_graph_generator --shard i/N (i = 0 ... N-1) in a single" << endl;
+  cout << "\t" << "graph file: the coordinates are copied from the first shard and the" << endl;
+  cout << "\t" << "links of all the shards are merged in the order of the generator." << endl;
+  cout << "\t" << "The files are read sequentially, the graph is not loaded in memory." << endl;
+  cout << "\t" << "Shard files keep their name (<graph file name>.shard<i>of<N>.hg), the" << endl;
+  cout << "\t" << "merge fails unless the N shards of the graph are provided once each." << endl;
+  cout << endl;
+  cout << "PARAMETERS:"<< endl;
+  cout << "\t" << "-o" << "\t" << "output graph file (in hg format)" << endl;
+  cout << "\t" << "\t" << "default value is ./graph.hg" << endl;
+  cout << "\t" << "-h" << "\t" << "print help menu" << endl; 
+  cout << endl;
+  cout << "OUTPUT:" << endl;
+  cout << "\t" << "The program writes the graph file, it is the same as the graph generated" << endl;
+  cout << "\t" << "at once with the same parameters and pair random numbers (-r)." << endl;
+  cout << endl;
+  return;
+}
+
+
+int main (int argc, char **argv) {
+
+  // default values
+  string graph_file = "./graph.hg";
+
+  hg_debug("parsing options");
+
+  int c;  
+  opterr = 0;
+ 
+  while ((c = getopt (argc, argv, "o:h")) != -1) {
+    switch (c) {
+    case 'o':
+      graph_file = optarg;
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    case '?':
+      cout << "Unknown option provided" << endl << endl;
+      usage(argv[0]);
+      return 1;
+    default:
+      cout << "Unknown option provided" << endl << endl;
+      usage(argv[0]);     
+      return 1;
+    }
+  }
+
+  vector<string> shard_files;
+  int i;
+  for(i = optind; i < argc; i++) {
+    if(graph_file == argv[i]) {
+      hg_enduser_warning("The merged graph cannot overwrite %s. \n\t  Quitting.", argv[i]);
+      return 1;
+    }
+    shard_files.push_back(argv[i]);
+  }
+  if(shard_files.empty()) {
+    hg_enduser_warning("No shard provided. \n\t  Quitting.");
+    usage(argv[0]);
+    return 1;
+  }
+
+  hg_debug("merging %lu shards", shard_files.size());
+  if(!hg_merge_shards(shard_files, graph_file)) {
+    hg_enduser_warning("Shards cannot be merged. \n\t  Quitting.");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,579 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/time.h>
+
+#include "hg_graphs_lib.h"
+#include "hg_random.h"
+#include "hg_scheduler.h"
+#include "hg_debug.h"
+#include "properties.h"
+
+
+unsigned long triangles(const hg_csr_t & csr, const unsigned int id) {
+  const unsigned int * nv = &csr.neighbours[0] + csr.offsets[id];
+  const unsigned int * nv_end = &csr.neighbours[0] + csr.offsets[id+1];
+  unsigned long count = 0;
+  /* every triangle (id,u,w) with u < w is counted once:
+   * for each neighbour u we merge the part of the neighbour
+   * list of id that follows u with the neighbours of u
+   * having id greater than u (both lists are sorted) */
+  for(; nv != nv_end; nv++) {
+    unsigned int u = *nv;
+    const unsigned int * a = nv + 1;
+    const unsigned int * b = &csr.neighbours[0] + csr.offsets[u];
+    const unsigned int * b_end = &csr.neighbours[0] + csr.offsets[u+1];
+    b = upper_bound(b, b_end, u);
+    while(a != nv_end && b != b_end) {
+      if(*a < *b) {
+	a++;
+      }
+      else if(*b < *a) {
+	b++;
+      }
+      else {
+	count++;
+	a++;
+	b++;
+      }
+    }
+  }
+  return count;
+}
+
+
+void node_properties(const hg_csr_t & csr, node_properties_t & np,
+		     const bool clustering) {
+  long n = csr.offsets.size() - 1;
+  long id;
+  np.degree.resize(n);
+  np.knn.resize(n);
+  np.cc.resize(clustering ? n : 0);
+  for(id = 0; id < n; id++) {
+    np.degree[id] = csr.offsets[id+1] - csr.offsets[id];
+  }
+  /* hubs take much longer than peripheral nodes, hence nodes
+   * are scheduled by cost: the neighbours are visited once for
+   * knn, and the triangles of node id are found merging its list
+   * with the one of each neighbour u (k + k_u steps at most) */
+  vector<double> costs(n);
+  for(id = 0; id < n; id++) {
+    double k = np.degree[id];
+    costs[id] = 1 + k;
+    if(clustering) {
+      size_t i;
+      costs[id] += k * k;
+      for(i = csr.offsets[id]; i < csr.offsets[id+1]; i++) {
+	costs[id] += np.degree[csr.neighbours[i]];
+      }
+    }
+  }
+  hg_scheduler_t * scheduler = hg_scheduler_new(costs, (n + 63) / 64, false);
+#pragma omp parallel private(id)
+  {
+    long task, first, last;
+    while(hg_scheduler_next(scheduler, task, first, last)) {
+      for(id = first; id < last; id++) {
+	size_t k = np.degree[id];
+	if(k == 0) {
+	  np.knn[id] = 0;
+	  if(clustering) {
+	    np.cc[id] = 0;
+	  }
+	  continue;
+	}
+	// knn
+	double knn = 0;
+	size_t i;
+	for(i = csr.offsets[id]; i < csr.offsets[id+1]; i++) {
+	  knn += np.degree[csr.neighbours[i]];
+	}
+	np.knn[id] = knn / k;
+	if(!clustering) continue;
+	// clustering coefficient (same definition as
+	// boost::clustering_coefficient)
+	double routes = k * (k - 1) / 2;
+	np.cc[id] = (routes > 0) ? triangles(csr, id) / routes : 0;
+      }
+    }
+  }
+  hg_scheduler_free(scheduler, "node_properties");
+}
+
+
+/* ================= streaming (out of core) properties  ================= */
+
+
+/* a link oriented from the node having lower rank to the node
+ * having higher rank, rank is given by degree (ties broken by
+ * id), hence every node has at most sqrt(2m) out-neighbours */
+typedef pair<unsigned int, unsigned int> oriented_link_t;
+
+#define PARTITION_BUFFER_SIZE (1 << 16)
+
+
+/* links whose source belongs to [first, last) are
+ * stored in a temporary file */
+typedef struct struct_partition {
+  unsigned int first;
+  unsigned int last;
+  FILE * file;
+  vector<oriented_link_t> buffer;
+} partition_t;
+
+
+/* out-neighbours of the nodes in a partition, CSR indexed
+ * by (id - first), neighbour lists are sorted by id */
+typedef struct struct_partition_csr {
+  unsigned int first;
+  unsigned int last;
+  vector<size_t> offsets;
+  vector<unsigned int> neighbours;
+} partition_csr_t;
+
+
+static inline bool lower_rank(const vector<unsigned int> & degree,
+			      const unsigned int u, const unsigned int v) {
+  return degree[u] < degree[v] || (degree[u] == degree[v] && u < v);
+}
+
+
+static bool partition_flush(partition_t & p) {
+  if(p.buffer.empty()) {
+    return true;
+  }
+  size_t written = fwrite(&p.buffer[0], sizeof(oriented_link_t), p.buffer.size(), p.file);
+  bool ok = (written == p.buffer.size());
+  p.buffer.clear();
+  return ok;
+}
+
+
+static bool partition_load(partition_t & p, partition_csr_t & pc) {
+  vector<oriented_link_t> links;
+  long size;
+  if(fseek(p.file, 0, SEEK_END) != 0 || (size = ftell(p.file)) < 0) {
+    return false;
+  }
+  links.resize(size / sizeof(oriented_link_t));
+  rewind(p.file);
+  if(!links.empty() &&
+     fread(&links[0], sizeof(oriented_link_t), links.size(), p.file) != links.size()) {
+    return false;
+  }
+  // counting sort by source
+  unsigned int id;
+  size_t i;
+  pc.first = p.first;
+  pc.last = p.last;
+  pc.offsets.assign((size_t)(p.last - p.first) + 1, 0);
+  for(i = 0; i < links.size(); i++) {
+    pc.offsets[links[i].first - p.first + 1]++;
+  }
+  for(id = p.first; id < p.last; id++) {
+    pc.offsets[id - p.first + 1] += pc.offsets[id - p.first];
+  }
+  vector<size_t> pos(pc.offsets.begin(), pc.offsets.end() - 1);
+  pc.neighbours.resize(links.size());
+  for(i = 0; i < links.size(); i++) {
+    pc.neighbours[pos[links[i].first - p.first]++] = links[i].second;
+  }
+  long j;
+  long range = p.last - p.first;
+#pragma omp parallel for schedule(dynamic, 1024)
+  for(j = 0; j < range; j++) {
+    sort(pc.neighbours.begin() + pc.offsets[j], pc.neighbours.begin() + pc.offsets[j+1]);
+  }
+  return true;
+}
+
+
+/* every triangle a -> b -> c (a -> c) is found once: when
+ * a is visited in outer and b belongs to inner */
+static void partition_triangles(const partition_csr_t & outer,
+				const partition_csr_t & inner,
+				vector<unsigned long> & tri) {
+  long range = outer.last - outer.first;
+  long j;
+  // the out-neighbours of a are merged with the ones of each of them
+  vector<double> costs(range);
+  for(j = 0; j < range; j++) {
+    double k = outer.offsets[j+1] - outer.offsets[j];
+    costs[j] = 1 + k * k;
+  }
+  hg_scheduler_t * scheduler = hg_scheduler_new(costs, (range + 63) / 64, false);
+#pragma omp parallel private(j)
+  {
+    long task, first, last;
+    while(hg_scheduler_next(scheduler, task, first, last)) {
+      for(j = first; j < last; j++) {
+	unsigned int a = outer.first + j;
+	const unsigned int * na = &outer.neighbours[0] + outer.offsets[j];
+	const unsigned int * na_end = &outer.neighbours[0] + outer.offsets[j+1];
+	const unsigned int * it;
+	for(it = na; it != na_end; it++) {
+	  unsigned int b = *it;
+	  if(b < inner.first || b >= inner.last) continue;
+	  const unsigned int * x = na;
+	  const unsigned int * nb = &inner.neighbours[0] + inner.offsets[b - inner.first];
+	  const unsigned int * nb_end = &inner.neighbours[0] + inner.offsets[b - inner.first + 1];
+	  while(x != na_end && nb != nb_end) {
+	    if(*x < *nb) {
+	      x++;
+	    }
+	    else if(*nb < *x) {
+	      nb++;
+	    }
+	    else {
+#pragma omp atomic
+	      tri[a]++;
+#pragma omp atomic
+	      tri[b]++;
+#pragma omp atomic
+	      tri[*x]++;
+	      x++;
+	      nb++;
+	    }
+	  }
+	}
+      }
+    }
+  }
+  hg_scheduler_free(scheduler, "partition_triangles");
+}
+
+
+bool stream_node_properties(const string filename, const string tmp_folder,
+			    const size_t memory, hg_parameters_t & par,
+			    vector<double> & r, vector<double> & theta,
+			    node_properties_t & np) {
+  unsigned int id, u, v;
+  hg_coordinate_t c;
+  size_t m = 0;
+  size_t i;
+  // first pass: coordinates and degrees
+  hg_stream_t * s = hg_stream_open(filename, par);
+  if(s == NULL) {
+    return false;
+  }
+  unsigned int n = par.expected_n;
+  r.assign(n, 0);
+  theta.assign(n, 0);
+  np.degree.assign(n, 0);
+  while(hg_stream_read_coordinate(s, id, c)) {
+    if(id >= n) continue;
+    r[id] = c.r;
+    theta[id] = c.theta;
+  }
+  while(hg_stream_read_link(s, u, v)) {
+    if(u >= n || v >= n) {
+      hg_log_err("File %s: link %u - %u out of range", filename.c_str(),
+		 u + par.starting_id, v + par.starting_id);
+      hg_stream_close(s);
+      return false;
+    }
+    np.degree[u]++;
+    np.degree[v]++;
+    m++;
+  }
+  hg_stream_close(s);
+  hg_debug("first pass: %u nodes, %lu links", n, m);
+
+  /* partitions are contiguous id ranges, the degree is an upper
+   * bound of the number of out-neighbours, two partitions have
+   * to fit in memory at the same time */
+  size_t max_links = max((size_t) 1, memory / 2 / (sizeof(unsigned int) + sizeof(oriented_link_t)));
+  vector<partition_t> partitions;
+  size_t links = 0;
+  unsigned int first = 0;
+  for(id = 0; id < n; id++) {
+    if(links > 0 && links + np.degree[id] > max_links) {
+      partition_t p = { first, id, NULL, vector<oriented_link_t>() };
+      partitions.push_back(p);
+      first = id;
+      links = 0;
+    }
+    links += np.degree[id];
+  }
+  partition_t last_p = { first, n, NULL, vector<oriented_link_t>() };
+  partitions.push_back(last_p);
+  vector<unsigned int> partition_last;
+  bool ok = true;
+  for(i = 0; i < partitions.size(); i++) {
+    string tmp_name = tmp_folder + "/.graph_properties_XXXXXX";
+    vector<char> tmp_path(tmp_name.begin(), tmp_name.end());
+    tmp_path.push_back('\0');
+    int fd = mkstemp(&tmp_path[0]);
+    if(fd == -1 || (partitions[i].file = fdopen(fd, "w+b")) == NULL) {
+      hg_log_err("Unable to create a temporary file in %s", tmp_folder.c_str());
+      ok = false;
+      break;
+    }
+    // the file is removed as soon as it is closed
+    unlink(&tmp_path[0]);
+    partitions[i].buffer.reserve(PARTITION_BUFFER_SIZE);
+    partition_last.push_back(partitions[i].last);
+  }
+  hg_debug("%lu partitions", partitions.size());
+
+  // second pass: knn and oriented links
+  np.knn.assign(n, 0);
+  if(ok && (s = hg_stream_open(filename, par)) != NULL) {
+    while(hg_stream_read_link(s, u, v)) {
+      np.knn[u] += np.degree[v];
+      np.knn[v] += np.degree[u];
+      if(!lower_rank(np.degree, u, v)) {
+	swap(u, v);
+      }
+      partition_t & p = partitions[upper_bound(partition_last.begin(), partition_last.end(), u) -
+				   partition_last.begin()];
+      p.buffer.push_back(make_pair(u, v));
+      if(p.buffer.size() == PARTITION_BUFFER_SIZE) {
+	ok = ok && partition_flush(p);
+      }
+    }
+    hg_stream_close(s);
+  }
+  else {
+    ok = false;
+  }
+  for(i = 0; i < partitions.size(); i++) {
+    ok = ok && partition_flush(partitions[i]);
+  }
+
+  // triangles: every pair of partitions is visited once
+  vector<unsigned long> tri(ok ? n : 0, 0);
+  size_t j;
+  partition_csr_t inner, outer;
+  for(i = 0; ok && i < partitions.size(); i++) {
+    ok = partition_load(partitions[i], inner);
+    for(j = 0; ok && j < partitions.size(); j++) {
+      if(j == i) {
+	partition_triangles(inner, inner, tri);
+      }
+      else if((ok = partition_load(partitions[j], outer))) {
+	partition_triangles(outer, inner, tri);
+      }
+    }
+  }
+  for(i = 0; i < partitions.size(); i++) {
+    if(partitions[i].file != NULL) {
+      fclose(partitions[i].file);
+    }
+  }
+  if(!ok) {
+    hg_log_err("Unable to compute the properties of %s", filename.c_str());
+    return false;
+  }
+
+  np.cc.assign(n, 0);
+  for(id = 0; id < n; id++) {
+    size_t k = np.degree[id];
+    if(k == 0) continue;
+    np.knn[id] = np.knn[id] / k;
+    double routes = k * (k - 1) / 2;
+    np.cc[id] = (routes > 0) ? tri[id] / routes : 0;
+  }
+  return true;
+}
+
+
+/* ================= approximate clustering (wedge sampling)  ================= */
+
+
+#define WEDGE_SAMPLING_Z 1.96         // 95% confidence
+#define WEDGE_SAMPLING_ROUND 1024     // samples per class per round
+
+
+/* sampling state of a degree class: a wedge is sampled picking
+ * a node of the class and then two of its neighbours uniformly
+ * at random, every node in the class has the same number of
+ * wedges, hence the fraction of closed wedges estimates the
+ * average clustering coefficient of the class */
+typedef struct struct_degree_class_sampler {
+  unsigned int k;
+  size_t first;               // nodes of the class are
+  size_t last;                // class_nodes[first,last)
+  unsigned long samples;
+  unsigned long closed;
+  bool done;
+  HG_RandomGenerator_t generator;
+} degree_class_sampler_t;
+
+
+static double wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+static inline bool is_link(const hg_csr_t & csr, const unsigned int u, const unsigned int v) {
+  const unsigned int * nu = &csr.neighbours[0] + csr.offsets[u];
+  const unsigned int * nu_end = &csr.neighbours[0] + csr.offsets[u+1];
+  return binary_search(nu, nu_end, v);
+}
+
+
+// half width of the Wilson score interval
+static double wilson_error(const unsigned long closed, const unsigned long samples) {
+  if(samples == 0) {
+    return 1;
+  }
+  double z2 = WEDGE_SAMPLING_Z * WEDGE_SAMPLING_Z;
+  double p = (double) closed / samples;
+  return WEDGE_SAMPLING_Z * sqrt(p * (1 - p) / samples + z2 / (4.0 * samples * samples)) /
+    (1 + z2 / samples);
+}
+
+
+void approximate_clustering(const hg_csr_t & csr, const vector<unsigned int> & degree,
+			    const double error, const double time_budget,
+			    const unsigned int seed, clustering_estimate_t & ce) {
+  double start = wall_time();
+  size_t n = degree.size();
+  size_t id;
+  unsigned int k;
+  // nodes grouped by degree (counting sort)
+  unsigned int max_k = 0;
+  for(id = 0; id < n; id++) {
+    max_k = max(max_k, degree[id]);
+  }
+  vector<size_t> class_offsets((size_t) max_k + 2, 0);
+  for(id = 0; id < n; id++) {
+    class_offsets[degree[id] + 1]++;
+  }
+  for(k = 0; k <= max_k; k++) {
+    class_offsets[k+1] += class_offsets[k];
+  }
+  vector<unsigned int> class_nodes(n);
+  vector<size_t> pos(class_offsets.begin(), class_offsets.end() - 1);
+  for(id = 0; id < n; id++) {
+    class_nodes[pos[degree[id]]++] = id;
+  }
+  /* worst case (p = 1/2) number of samples required
+   * for the confidence interval to be narrower than error */
+  double required = WEDGE_SAMPLING_Z * WEDGE_SAMPLING_Z / (4.0 * error * error);
+
+  ce.cc_k.assign((size_t) max_k + 1, 0);
+  ce.cc_k_error.assign((size_t) max_k + 1, 0);
+  ce.samples = 0;
+  ce.exact = true;
+  vector<degree_class_sampler_t> samplers;
+  for(k = 2; k <= max_k; k++) {
+    size_t nodes = class_offsets[k+1] - class_offsets[k];
+    if(nodes == 0) continue;
+    double wedges = (double) nodes * k * (k - 1.0) / 2.0;
+    if(wedges <= required) {
+      // exact computation for this class
+      double cc = 0;
+      for(id = class_offsets[k]; id < class_offsets[k+1]; id++) {
+	cc += triangles(csr, class_nodes[id]) / (k * (k - 1.0) / 2.0);
+      }
+      ce.cc_k[k] = cc / nodes;
+      continue;
+    }
+    degree_class_sampler_t s;
+    s.k = k;
+    s.first = class_offsets[k];
+    s.last = class_offsets[k+1];
+    s.samples = 0;
+    s.closed = 0;
+    s.done = false;
+    s.generator.seed(seed + k);
+    samplers.push_back(s);
+    ce.exact = false;
+  }
+
+  // sampling rounds, classes are independent
+  bool done = samplers.empty();
+  long i;
+  while(!done) {
+#pragma omp parallel for schedule(dynamic, 1)
+    for(i = 0; i < (long) samplers.size(); i++) {
+      degree_class_sampler_t & s = samplers[i];
+      if(s.done) continue;
+      boost::uniform_int<size_t> node_dist(s.first, s.last - 1);
+      boost::uniform_int<unsigned int> first_dist(0, s.k - 1);
+      boost::uniform_int<unsigned int> second_dist(0, s.k - 2);
+      int r;
+      for(r = 0; r < WEDGE_SAMPLING_ROUND; r++) {
+	unsigned int v = class_nodes[node_dist(s.generator)];
+	unsigned int a = first_dist(s.generator);
+	unsigned int b = second_dist(s.generator);
+	if(b >= a) b++;
+	a = csr.neighbours[csr.offsets[v] + a];
+	b = csr.neighbours[csr.offsets[v] + b];
+	if(degree[a] <= degree[b] ? is_link(csr, a, b) : is_link(csr, b, a)) {
+	  s.closed++;
+	}
+      }
+      s.samples += WEDGE_SAMPLING_ROUND;
+      s.done = (wilson_error(s.closed, s.samples) <= error);
+    }
+    done = true;
+    for(i = 0; i < (long) samplers.size(); i++) {
+      done = done && samplers[i].done;
+    }
+    if(time_budget > 0 && wall_time() - start >= time_budget) {
+      hg_debug("time budget is over");
+      break;
+    }
+  }
+  for(i = 0; i < (long) samplers.size(); i++) {
+    k = samplers[i].k;
+    ce.cc_k[k] = (double) samplers[i].closed / samplers[i].samples;
+    ce.cc_k_error[k] = wilson_error(samplers[i].closed, samplers[i].samples);
+    ce.samples += samplers[i].samples;
+  }
+
+  /* classes are independent estimates: average clustering and
+   * transitivity are weighted sums of the classes (by number of
+   * nodes and by number of wedges respectively) */
+  double nodes = n - (class_offsets[1] - class_offsets[0]);  // k > 0
+  double wedges = 0;
+  double cc = 0, cc_var = 0, closed = 0, closed_var = 0;
+  for(k = 2; k <= max_k; k++) {
+    double nodes_k = class_offsets[k+1] - class_offsets[k];
+    double wedges_k = nodes_k * k * (k - 1.0) / 2.0;
+    double sigma_k = ce.cc_k_error[k] / WEDGE_SAMPLING_Z;
+    wedges += wedges_k;
+    cc += nodes_k * ce.cc_k[k];
+    cc_var += nodes_k * nodes_k * sigma_k * sigma_k;
+    closed += wedges_k * ce.cc_k[k];
+    closed_var += wedges_k * wedges_k * sigma_k * sigma_k;
+  }
+  ce.avg_cc = (nodes > 0) ? cc / nodes : 0;
+  ce.avg_cc_error = (nodes > 0) ? WEDGE_SAMPLING_Z * sqrt(cc_var) / nodes : 0;
+  ce.transitivity = (wedges > 0) ? closed / wedges : 0;
+  ce.transitivity_error = (wedges > 0) ? WEDGE_SAMPLING_Z * sqrt(closed_var) / wedges : 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _PROPERTIES_H
+#define _PROPERTIES_H
+
+#include <vector>
+#include <string>
+
+#include "hg_formats.h"
+
+using namespace std;
+
+
+/* Per-node properties of a graph, stored in
+ * flat vectors indexed by node id [0,n-1] */
+typedef struct struct_node_properties {
+  vector<unsigned int> degree;  // node degree
+  vector<double> knn;           // average neighbour degree
+  vector<double> cc;            // clustering coefficient
+} node_properties_t;
+
+
+// number of triangles node id belongs to
+unsigned long triangles(const hg_csr_t & csr, const unsigned int id);
+
+/* degree, knn and (unless clustering is false)
+ * clustering coefficient of every node */
+void node_properties(const hg_csr_t & csr, node_properties_t & np,
+		     const bool clustering = true);
+
+/* same as node_properties, but the graph is never loaded:
+ * the .hg file is read twice (degrees first, then knn and
+ * triangles) and the links, oriented from the lower to the
+ * higher degree node, are stored in temporary files in
+ * tmp_folder; at most memory bytes of links are loaded at
+ * the same time. Coordinates are returned in r and theta.
+ * The input is expected to be a simple graph, as generated
+ * by hyperbolic_graph_generator. Returns false on error */
+bool stream_node_properties(const string filename, const string tmp_folder,
+			    const size_t memory, hg_parameters_t & par,
+			    vector<double> & r, vector<double> & theta,
+			    node_properties_t & np);
+
+
+
+/* Clustering estimated by wedge sampling, degree classes
+ * are indexed by degree k and every value is given with the
+ * half width of its 95% confidence interval */
+typedef struct struct_clustering_estimate {
+  vector<double> cc_k;        // avg. clustering coefficient of nodes having degree k
+  vector<double> cc_k_error;
+  double avg_cc;              // avg. clustering coefficient (nodes having k > 0)
+  double avg_cc_error;
+  double transitivity;        // fraction of closed wedges (global clustering)
+  double transitivity_error;
+  unsigned long samples;      // number of wedges sampled
+  bool exact;                 // true if no class has been sampled
+} clustering_estimate_t;
+
+/* estimate the clustering of every degree class sampling
+ * wedges uniformly (in parallel) until the confidence interval
+ * of each class is narrower than error, or until time_budget
+ * seconds have passed (0 means no budget). Classes having
+ * fewer wedges than the samples required are computed
+ * exactly, hence small graphs are always computed exactly.
+ * Results depend on seed only, not on the number of threads
+ * (unless the time budget is hit) */
+void approximate_clustering(const hg_csr_t & csr, const vector<unsigned int> & degree,
+			    const double error, const double time_budget,
+			    const unsigned int seed, clustering_estimate_t & ce);
+
+
+#endif /* _PROPERTIES_H */
+
@@ -0,0 +1,155 @@
+/*
+ * Hyperbolic Graph Generator
+ *
+ * Chiara Orsini, CAIDA, UC San Diego
+ * chiara@caida.org
+ *
+ * Copyright (C) 2014 The Regents of the University of California.
+ *
+ * This file is part of the Hyperbolic Graph Generator.
+ *
+ * The Hyperbolic Graph Generator is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or  (at your option) any later version.
+ *
+ * The Hyperbolic Graph Generator is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the Hyperbolic Graph Generator.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hg_graphs_lib.h"
+#include "hg_debug.h"
+
+using namespace std;
+
+
+void usage (string exe_name){
+  cout << "NAME: " << endl;
+  cout << "\t" << "relabel_graph" << " -- relabel the nodes of a hyperbolic graph " << endl;
+  cout << endl;
+  cout << "SYNOPSIS: " << endl;
+  cout << "\t" << "relabel_graph" << " [parameters] " << endl;
+  cout << endl;
+  cout << "DESCRIPTION:" << endl;
+  cout << "\t" << "The program loads in memory a hyperbolic graph (./graph.hg by default)" << endl;
+  cout << "\t" << "and assigns new ids to its nodes, sorted by angular coordinate or along" << endl;
+  cout << "\t" << "a Hilbert curve in (theta, r): nodes close in the space get close ids," << endl;
+  cout << "\t" << "hence the tools access memory with better locality. The relabelled" << endl;
+  cout << "\t" << "graph and the permutation (to recover the original ids) are written." << endl;
+  cout << endl;
+  cout << "PARAMETERS:"<< endl;
+  cout << "\t" << "-i" << "\t" << "input graph file (in hg format)" << endl;
+  cout << "\t" << "\t" << "default value is ./graph.hg" << endl;
+  cout << "\t" << "-o" << "\t" << "output graph file (in hg format, compressed" << endl;
+  cout << "\t" << "\t" << "if the extension is .hgc)" << endl;
+  cout << "\t" << "\t" << "default value is ./graph_relabelled.hg" << endl;
+  cout << "\t" << "-m" << "\t" << "order of the new ids: angle or hilbert" << endl;
+  cout << "\t" << "\t" << "default value is angle" << endl;
+  cout << "\t" << "-h" << "\t" << "print help menu" << endl; 
+  cout << endl;
+  cout << "OUTPUT:" << endl;
+  cout << "\t" << "The program writes the relabelled graph and, in the same folder, the" << endl;
+  cout << "\t" << "permutation file (.perm extension instead of .hg) that contains a" << endl;
+  cout << "\t" << "<new id> <original id> line per node." << endl;
+  cout << endl;
+  return;
+}
+
+
+int main (int argc, char **argv) {
+
+  // default values
+  string graph_file = "./graph.hg";
+  string out_file = "./graph_relabelled.hg";
+  hg_node_order order = HG_ORDER_ANGLE;
+
+  hg_debug("parsing options");
+
+  int c;  
+  opterr = 0;
+ 
+  while ((c = getopt (argc, argv, "i:o:m:h")) != -1) {
+    switch (c) {
+    case 'i':
+      graph_file = optarg;
+      break;
+    case 'o':
+      out_file = optarg;
+      break;
+    case 'm':
+      if(string(optarg) == "hilbert") {
+	order = HG_ORDER_HILBERT;
+      }
+      else if(string(optarg) == "angle") {
+	order = HG_ORDER_ANGLE;
+      }
+      else {
+	cout << "Unknown order provided" << endl << endl;
+	usage(argv[0]);
+	return 1;
+      }
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    case '?':
+      cout << "Unknown option provided" << endl << endl;
+      usage(argv[0]);
+      return 1;
+    default:
+      cout << "Unknown option provided" << endl << endl;
+      usage(argv[0]);     
+      return 1;
+    }
+  }
+
+  if(out_file == graph_file) {
+    hg_enduser_warning("The relabelled graph cannot overwrite %s. \n\t  Quitting.", graph_file.c_str());
+    return 1;
+  }
+
+  hg_debug("reading hg graph");
+  hg_graph_t *graph = hg_read_graph(graph_file);
+  if(graph == NULL) {
+    hg_enduser_warning("Empty topology - %s \n\t  Quitting.", graph_file.c_str());
+    return 1;
+  }
+
+  vector<unsigned int> permutation;
+  hg_graph_t *relabelled = hg_relabel_graph(graph, order, permutation);
+  delete graph;
+
+  string perm_file = out_file;
+  if(perm_file.size() > 3 && perm_file.substr(perm_file.size() - 3) == ".gz") {
+    perm_file = perm_file.substr(0, perm_file.size() - 3);
+  }
+  if(perm_file.size() > 3 && perm_file.substr(perm_file.size() - 3) == ".hg") {
+    perm_file = perm_file.substr(0, perm_file.size() - 3);
+  }
+  else if(perm_file.size() > 4 && perm_file.substr(perm_file.size() - 4) == ".hgc") {
+    perm_file = perm_file.substr(0, perm_file.size() - 4);
+  }
+  perm_file += ".perm";
+
+  hg_print_graph(relabelled, out_file);
+  bool written = hg_print_permutation(permutation, (*relabelled)[boost::graph_bundle].starting_id,
+				      perm_file);
+  delete relabelled;
+
+  return written ? 0 : 1;
+}
@@ -24,107 +24,153 @@
  *
  */
 
-#include "stats.h"
+#include <algorithm>
+#if defined(_OPENMP) && defined(__GLIBCXX__)
+#include <parallel/algorithm>
+#endif
 
+#include "stats.h"
 
-map<double,int> frequencies(const map<int,double>& id_property) {
 
-    map<double,int> frequencies_map;
-    map<int,double> :: const_iterator it;
-    map<double,int> :: iterator f;
-    for(it = id_property.begin(); it != id_property.end(); it++) {
-      f = frequencies_map.find(it->second);
-      if(f == frequencies_map.end()) {
-	frequencies_map.insert(make_pair(it->second, 1));
-      }
-      else{
-	f->second++;
-      }
-    }
-    return frequencies_map;
+static void sort_values(vector<double>& values) {
+#if defined(_OPENMP) && defined(__GLIBCXX__)
+  __gnu_parallel::sort(values.begin(), values.end());
+#else
+  sort(values.begin(), values.end());
+#endif
 }
 
 
-map<double,double> pdf(const map<int,double>& id_property) {
+vector<size_t> histogram(const vector<unsigned int>& values) {
+  vector<size_t> h;
+  size_t i;
+  unsigned int max_value = 0;
+  for(i = 0; i < values.size(); i++) {
+    max_value = max(max_value, values[i]);
+  }
+  if(values.size() != 0) {
+    h.resize((size_t) max_value + 1, 0);
+  }
+  for(i = 0; i < values.size(); i++) {
+    h[values[i]]++;
+  }
+  return h;
+}
+
 
-  map<double,double> pdf;  
-  int instances = id_property.size();
+distribution_t pdf(const vector<size_t>& histogram) {
+  distribution_t pdf;
+  size_t instances = 0;
+  size_t v;
+  for(v = 0; v < histogram.size(); v++) {
+    instances += histogram[v];
+  }
   if(instances != 0) {
-    map<double,int> frequencies_map = frequencies(id_property);
-    map<double,int> :: const_iterator it;
-    for(it = frequencies_map.begin(); it != frequencies_map.end(); it++) {
-      pdf.insert(make_pair(it->first, (double)it->second/(double)instances));
+    for(v = 0; v < histogram.size(); v++) {
+      if(histogram[v] == 0) continue;
+      pdf.push_back(make_pair((double) v, (double)histogram[v]/(double)instances));
     }
   }
   return pdf;
 }
 
 
-map<double,double> ccdf(const map<int,double>& id_property) {
-
-  map<double,double> ccdf_map;  
-  map<double,double> :: iterator c;  
-  int instances = id_property.size();
-  int ccdf_val = instances;
+distribution_t ccdf(const vector<size_t>& histogram) {
+  distribution_t ccdf;
+  size_t instances = 0;
+  size_t v;
+  for(v = 0; v < histogram.size(); v++) {
+    instances += histogram[v];
+  }
+  // ccdf(v) = fraction of instances greater than v
+  size_t ccdf_val = instances;
   if(instances != 0) {
-    map<double,int> frequencies_map = frequencies(id_property);
-    map<double,int> :: const_iterator it;
-    for(it = frequencies_map.begin(); it != frequencies_map.end(); it++) {
-      ccdf_val = ccdf_val - it->second;
-      ccdf_map.insert(make_pair(it->first, (double)ccdf_val));
-    }
-    for(c = ccdf_map.begin(); c!=ccdf_map.end(); c++) {
-      c->second = (double) c->second / (double) instances;
+    for(v = 0; v < histogram.size(); v++) {
+      if(histogram[v] == 0) continue;
+      ccdf_val = ccdf_val - histogram[v];
+      ccdf.push_back(make_pair((double) v, (double)ccdf_val/(double)instances));
     }
   }
-  return ccdf_map;
+  return ccdf;
 }
 
 
+distribution_t pdf(vector<double> values) {
+  distribution_t pdf;
+  size_t instances = values.size();
+  size_t i, j;
+  sort_values(values);
+  // each run of equal values is a distinct value
+  for(i = 0; i < instances; i = j) {
+    for(j = i + 1; j < instances && values[j] == values[i]; j++);
+    pdf.push_back(make_pair(values[i], (double)(j-i)/(double)instances));
+  }
+  return pdf;
+}
 
-map<double,double> avg_over_degree(const map<int,double> & id_degree,
-				   const map<int,double>& id_property) {
-  map<double,double> res;
-  map<double,int> frequencies_map = frequencies(id_degree);
-  map<int,double> :: const_iterator it;
-  map<int,double> :: const_iterator p;
-  map<double,double> :: iterator r;
-  for(it = id_degree.begin(); it != id_degree.end(); it++) {
-    p = id_property.find(it->first);
-    if( p != id_property.end()) {
-      r = res.find(it->second);
-      if(r == res.end()) {
-	// insert degree - other property
-	res.insert(make_pair(it->second, p->second));
-      }
-      else {
-	// add other property
-	r->second += p->second;
-      }
-    }
+
+distribution_t ccdf(vector<double> values) {
+  distribution_t ccdf;
+  size_t instances = values.size();
+  size_t i, j;
+  sort_values(values);
+  // ccdf(v) = fraction of instances greater than v
+  for(i = 0; i < instances; i = j) {
+    for(j = i + 1; j < instances && values[j] == values[i]; j++);
+    ccdf.push_back(make_pair(values[i], (double)(instances-j)/(double)instances));
   }
-  // then normalize res
-  map<double,int> :: const_iterator f;
-  for(r = res.begin(); r != res.end(); r++) {
-    f = frequencies_map.find(r->first);
-    if(f != frequencies_map.end()) {
-      r->second = r->second / (double)f->second;
-    }
+  return ccdf;
+}
+
+
+distribution_t avg_over_degree(const vector<unsigned int>& node_degree,
+			       const vector<double>& node_property) {
+  distribution_t res;
+  vector<size_t> h = histogram(node_degree);
+  vector<double> sum(h.size(), 0);
+  size_t id;
+  for(id = 0; id < node_degree.size(); id++) {
+    sum[node_degree[id]] += node_property[id];
+  }
+  return avg_over_degree(h, sum);
+}
+
+
+distribution_t avg_over_degree(const vector<size_t>& histogram,
+			       const vector<double>& property_sum) {
+  distribution_t res;
+  size_t k;
+  for(k = 0; k < histogram.size(); k++) {
+    if(histogram[k] == 0) continue;
+    res.push_back(make_pair((double) k, property_sum[k] / (double)histogram[k]));
   }
   return res;
 }
 
 
-void print(const string filename, const map<int,double>& id_property) {
+void add_node(degree_classes_t & dc, const unsigned int k,
+	      const double knn, const double cc) {
+  if(k >= dc.count.size()) {
+    dc.count.resize((size_t) k + 1, 0);
+    dc.knn.resize((size_t) k + 1, 0);
+    dc.cc.resize((size_t) k + 1, 0);
+  }
+  dc.count[k]++;
+  dc.knn[k] += knn;
+  dc.cc[k] += cc;
+}
+
+
+void print(const string filename, const distribution_t& distribution) {
   ofstream output_stream;
   // opening file
   output_stream.open(filename.c_str(), ios::out);
   // FILE IS OPEN CORRECTLY
   if (output_stream.is_open() && !output_stream.fail()) { 
     // printing content
-    map<int,double> :: const_iterator it;
-    for(it = id_property.begin(); it!= id_property.end(); it++) {
-      output_stream << it->first << "\t" << it->second << endl;
+    distribution_t :: const_iterator it;
+    for(it = distribution.begin(); it!= distribution.end(); it++) {
+      output_stream << it->first << "\t" << it->second << "\n";
     }
   }
   // SOME PROBLEM AROSE
@@ -136,16 +182,18 @@ void print(const string filename, const map<int,double>& id_property) {
 }
 
 
-void print(const string filename, const map<double,double>& id_property) {
+void print(const string filename, const distribution_t& distribution,
+	   const vector<double>& error) {
   ofstream output_stream;
   // opening file
   output_stream.open(filename.c_str(), ios::out);
   // FILE IS OPEN CORRECTLY
   if (output_stream.is_open() && !output_stream.fail()) { 
     // printing content
-    map<double,double> :: const_iterator it;
-    for(it = id_property.begin(); it!= id_property.end(); it++) {
-      output_stream << it->first << "\t" << it->second << endl;
+    distribution_t :: const_iterator it;
+    for(it = distribution.begin(); it!= distribution.end(); it++) {
+      output_stream << it->first << "\t" << it->second << "\t";
+      output_stream << error[(size_t) it->first] << "\n";
     }
   }
   // SOME PROBLEM AROSE
@@ -156,3 +204,48 @@ void print(const string filename, const map<double,double>& id_property) {
   output_stream.close();
 }
 
+
+void print(const string filename, const vector<double>& node_property,
+	   const vector<unsigned int>& node_degree, const unsigned int starting_id) {
+  ofstream output_stream;
+  // opening file
+  output_stream.open(filename.c_str(), ios::out);
+  // FILE IS OPEN CORRECTLY
+  if (output_stream.is_open() && !output_stream.fail()) { 
+    // printing content
+    size_t id;
+    for(id = 0; id < node_property.size(); id++) {
+      if(node_degree[id] == 0) continue;
+      output_stream << id + starting_id << "\t" << node_property[id] << "\n";
+    }
+  }
+  // SOME PROBLEM AROSE
+  else{
+    cerr << "ERROR opening " << filename << "!" << endl;		
+  }
+  // closing file
+  output_stream.close();
+}
+
+
+void print(const string filename, const vector<unsigned int>& node_property,
+	   const vector<unsigned int>& node_degree, const unsigned int starting_id) {
+  ofstream output_stream;
+  // opening file
+  output_stream.open(filename.c_str(), ios::out);
+  // FILE IS OPEN CORRECTLY
+  if (output_stream.is_open() && !output_stream.fail()) { 
+    // printing content (as double, like the map version)
+    size_t id;
+    for(id = 0; id < node_property.size(); id++) {
+      if(node_degree[id] == 0) continue;
+      output_stream << id + starting_id << "\t" << (double) node_property[id] << "\n";
+    }
+  }
+  // SOME PROBLEM AROSE
+  else{
+    cerr << "ERROR opening " << filename << "!" << endl;		
+  }
+  // closing file
+  output_stream.close();
+}
@@ -29,19 +29,65 @@
 
 #include <iostream>
 #include <fstream>
-#include <map>
+#include <vector>
+#include <utility>
 
 using namespace std;
 
 
-map<double,double> pdf(const map<int,double>& id_property);
-map<double,double> ccdf(const map<int,double>& id_property);
+/* A distribution is a list of <value, statistic> pairs
+ * sorted by value, e.g. <degree, probability> */
+typedef vector<pair<double,double> > distribution_t;
 
-map<double,double> avg_over_degree(const map<int,double> & id_degree,
-				   const map<int,double>& id_property);
 
-void print(const string filename, const map<int,double>& id_property);
-void print(const string filename, const map<double,double>& id_property);
+/* Integer (degree-like) properties are counted in a dense
+ * histogram: histogram[v] is the number of instances of v */
+vector<size_t> histogram(const vector<unsigned int>& values);
+
+distribution_t pdf(const vector<size_t>& histogram);
+distribution_t ccdf(const vector<size_t>& histogram);
+
+/* Continuous properties are sorted and then scanned once,
+ * the vector is taken by value and sorted in place */
+distribution_t pdf(vector<double> values);
+distribution_t ccdf(vector<double> values);
+
+/* average value of property for each degree class,
+ * vectors are indexed by node id [0,n-1] */
+distribution_t avg_over_degree(const vector<unsigned int>& node_degree,
+			       const vector<double>& node_property);
+
+/* average value of property for each degree class, given the
+ * degree histogram and the per-class sum of the property */
+distribution_t avg_over_degree(const vector<size_t>& histogram,
+			       const vector<double>& property_sum);
+
+
+/* Streaming aggregator of degree classes: nodes are added
+ * one at a time and memory is O(max degree), no per-node
+ * data is kept */
+typedef struct struct_degree_classes {
+  vector<size_t> count;  // number of nodes having degree k
+  vector<double> knn;    // sum of knn over the nodes having degree k
+  vector<double> cc;     // sum of cc over the nodes having degree k
+} degree_classes_t;
+
+void add_node(degree_classes_t & dc, const unsigned int k,
+	      const double knn, const double cc);
+
+void print(const string filename, const distribution_t& distribution);
+
+/* print <value> <statistic> <error>, the error
+ * vector is indexed by value (e.g. degree) */
+void print(const string filename, const distribution_t& distribution,
+	   const vector<double>& error);
+
+/* print the properties of the nodes having a non-zero degree, 
+ * vectors are indexed by node id [0,n-1] */
+void print(const string filename, const vector<double>& node_property,
+	   const vector<unsigned int>& node_degree, const unsigned int starting_id);
+void print(const string filename, const vector<unsigned int>& node_property,
+	   const vector<unsigned int>& node_degree, const unsigned int starting_id);
 
 
 #endif /* _STATS_H */